@@ -15,8 +15,11 @@
 #include "FairRootManager.h"
 #include "FairRun.h"
 #include "FairRuntimeDb.h"
+#include "FairSink.h"
 #include "FairVolume.h"
+#include "R3BGTPCCompactPoint.h"
 #include "R3BGTPCPoint.h"
+#include "R3BGTPCPointNames.h"
 #include "R3BMCStack.h"
 #include "TClonesArray.h"
 #include "TGeoMCGeometry.h"
@@ -56,6 +59,12 @@ R3BGTPC::R3BGTPC(const TString& geoFile, const TGeoTranslation& trans, const TGe
 
 R3BGTPC::R3BGTPC(const TString& geoFile, const TGeoCombiTrans& combi)
     : R3BDetector("R3BGTPC", kGTPC, geoFile, combi)
+    , fGTPCCompactPointCollection(nullptr)
+    , fPointNames(nullptr)
+    , fCompactPoints(kFALSE)
+    , fOnline(kFALSE)
+    , fAggregationLength(0.)
+    , fLastMergeable(kFALSE)
 {
     fGTPCPointCollection = new TClonesArray("R3BGTPCPoint");
 }
@@ -68,10 +77,20 @@ R3BGTPC::~R3BGTPC()
         fGTPCPointCollection->Delete();
         delete fGTPCPointCollection;
     }
+    if (fGTPCCompactPointCollection)
+    {
+        fGTPCCompactPointCollection->Delete();
+        delete fGTPCCompactPointCollection;
+    }
+    delete fPointNames;
 }
 // -------------------------------------------------------------------------
 
-void R3BGTPC::FinishRun() { ; }
+void R3BGTPC::FinishRun()
+{
+    if (fCompactPoints && !fOnline)
+        FairRootManager::Instance()->GetSink()->WriteObject(fPointNames, "GTPCPointNames");
+}
 
 // -------------------------------------------------------------------------
 void R3BGTPC::Initialize()
@@ -133,6 +152,8 @@ Bool_t R3BGTPC::ProcessHits(FairVolume* vol)
     TLorentzVector mom;
     gMC->TrackPosition(pos);
     gMC->TrackMomentum(mom);
+    Bool_t isEntering = gMC->IsNewTrack() || gMC->IsTrackEntering();
+    Bool_t isLeaving = gMC->IsTrackExiting() || gMC->IsTrackStop() || gMC->IsTrackDisappeared() || gMC->IsTrackOut();
     Int_t theTrackStatus = GetTrackStatus(gMC->IsNewTrack(),
                                           gMC->IsTrackDisappeared(),
                                           gMC->IsTrackStop(),
@@ -149,6 +170,30 @@ Bool_t R3BGTPC::ProcessHits(FairVolume* vol)
     if (gMC->TrackPid() != 0) // due to the INCL generator
     {
         Int_t size = fGTPCPointCollection->GetEntriesFast();
+        R3BGTPCPoint* last = size > 0 ? static_cast<R3BGTPCPoint*>(fGTPCPointCollection->At(size - 1)) : nullptr;
+        Bool_t sameTrack = last && last->GetTrackID() == gMC->GetStack()->GetCurrentTrackNumber();
+        if (fAggregationLength > 0. && !isEntering && !isLeaving && fLastMergeable && sameTrack &&
+            (pos.Vect() - fPortionStart).Mag() <= fAggregationLength)
+        {
+            // the step continues the track portion of the last point, whose
+            // status (inside the volume) is kept
+            last->SetPosition(pos.Vect());
+            last->SetMomentum(mom.Vect());
+            last->SetTime(gMC->TrackTime());
+            last->SetLength(gMC->TrackLength());
+            last->SetEnergyLoss(last->GetEnergyLoss() + gMC->Edep());
+            last->SetKineticEnergy(gMC->Etot() - gMC->TrackMass());
+            last->SetTrackStep(last->GetTrackStep() + gMC->TrackStep());
+            return kTRUE;
+        }
+        // the track portion of a new point starts at the previous point of its
+        // track, or at the point itself for the first one of a track
+        if (isEntering || !sameTrack)
+            fPortionStart = pos.Vect();
+        else
+            fPortionStart.SetXYZ(last->GetX(), last->GetY(), last->GetZ());
+        fLastMergeable = !isEntering && !isLeaving;
+
         new ((*fGTPCPointCollection)[size])
             R3BGTPCPoint(gMC->GetStack()->GetCurrentTrackNumber(), // trackID
                          vol->getModId(),                          // check if getModId or CurrentVolOffID(1,modID)
@@ -195,8 +240,34 @@ void R3BGTPC::EndOfEvent()
 }
 // ----------------------------------------------------------------------------
 
+// -----   Public method FinishEvent   ----------------------------------------
+void R3BGTPC::FinishEvent()
+{
+    if (!fCompactPoints)
+        return;
+    Int_t nPoints = fGTPCPointCollection->GetEntriesFast();
+    for (Int_t i = 0; i < nPoints; i++)
+    {
+        auto point = static_cast<R3BGTPCPoint*>(fGTPCPointCollection->At(i));
+        new ((*fGTPCCompactPointCollection)[i]) R3BGTPCCompactPoint(*point, *fPointNames);
+    }
+}
+// ----------------------------------------------------------------------------
+
 // -----   Public method Register   -------------------------------------------
-void R3BGTPC::Register() { FairRootManager::Instance()->Register("GTPCPoint", GetName(), fGTPCPointCollection, kTRUE); }
+void R3BGTPC::Register()
+{
+    // The R3BGTPCPoints are always produced during the transport, the stack
+    // updates their track indices through GetCollection(), and tasks of the
+    // simulation run read them from memory
+    FairRootManager::Instance()->Register("GTPCPoint", GetName(), fGTPCPointCollection, !fCompactPoints && !fOnline);
+    if (fCompactPoints)
+    {
+        fGTPCCompactPointCollection = new TClonesArray("R3BGTPCCompactPoint");
+        fPointNames = new R3BGTPCPointNames();
+        FairRootManager::Instance()->Register("GTPCCompactPoint", GetName(), fGTPCCompactPointCollection, !fOnline);
+    }
+}
 // ----------------------------------------------------------------------------
 
 // -----   Public method GetCollection   --------------------------------------
@@ -219,7 +290,12 @@ void R3BGTPC::Print(Option_t* option) const
 // ----------------------------------------------------------------------------
 
 // -----   Public method Reset   ----------------------------------------------
-void R3BGTPC::Reset() { fGTPCPointCollection->Clear(); }
+void R3BGTPC::Reset()
+{
+    fGTPCPointCollection->Clear();
+    if (fGTPCCompactPointCollection)
+        fGTPCCompactPointCollection->Clear();
+}
 
 //_________________________________________________________
 Bool_t R3BGTPC::CheckIfSensitive(std::string name)
@@ -15,9 +15,11 @@
 
 #include "R3BDetector.h"
 #include "TLorentzVector.h"
+#include "TVector3.h"
 
 class TClonesArray;
 class R3BGTPCPoint;
+class R3BGTPCPointNames;
 class FairVolume;
 
 class R3BGTPC : public R3BDetector
@@ -70,6 +72,13 @@ class R3BGTPC : public R3BDetector
      **/
     virtual void EndOfEvent();
 
+    /** Virtual method FinishEvent
+     **
+     ** In compact mode, converts the points of the event, with their track
+     ** indices already updated by the stack, to R3BGTPCCompactPoints.
+     **/
+    virtual void FinishEvent();
+
     /** Virtual method Register
      **
      ** Registers the hit collection in the ROOT manager.
@@ -97,6 +106,25 @@ class R3BGTPC : public R3BDetector
 
     virtual void SetSpecialPhysicsCuts();
 
+    /** Compact output: the branch GTPCCompactPoint of R3BGTPCCompactPoint and
+     ** the dictionary GTPCPointNames are written instead of GTPCPoint. Must be
+     ** set before the run is initialized. Default kFALSE **/
+    void SetCompactPoints(Bool_t compact = kTRUE) { fCompactPoints = compact; }
+
+    /** Accessor to select online mode: the points are only kept in memory for
+     ** the tasks run in the same process, as in a chained simulation and
+     ** digitization. Default kFALSE **/
+    void SetOnline(Bool_t option) { fOnline = option; }
+
+    /** Step aggregation: consecutive steps of a track inside the gas are
+     ** merged into one point as long as the merged point stays within length
+     ** [cm] of the start of its track portion, the previous point of the
+     ** track (e.g. a fraction of the pad size). Steps of tracks entering,
+     ** created, exiting, stopping or disappearing are never merged and keep
+     ** their own point, so the track status sequence read by the digitizers
+     ** is unchanged. Default 0 (every step is a point) **/
+    void SetStepAggregation(Double_t length) { fAggregationLength = length; }
+
     Int_t GetTrackStatus(bool NewTrack,
                          bool TrackDisappeared,
                          bool TrackStop,
@@ -108,6 +136,13 @@ class R3BGTPC : public R3BDetector
 
   private:
     TClonesArray* fGTPCPointCollection;
-
-    ClassDef(R3BGTPC, 1);
+    TClonesArray* fGTPCCompactPointCollection;
+    R3BGTPCPointNames* fPointNames;
+    Bool_t fCompactPoints;
+    Bool_t fOnline; // Selector for online data storage
+    Double_t fAggregationLength; // Largest length of an aggregated track portion [cm]
+    TVector3 fPortionStart;      // Start of the track portion of the last point
+    Bool_t fLastMergeable;       // Last point can take the next step of its track
+
+    ClassDef(R3BGTPC, 2);
 };
@@ -0,0 +1,298 @@
+/******************************************************************************
+ *   Copyright (C) 2018 GSI Helmholtzzentrum für Schwerionenforschung GmbH    *
+ *   Copyright (C) 2018-2025 Members of R3B Collaboration                     *
+ *                                                                            *
+ *             This software is distributed under the terms of the            *
+ *                 GNU Lesser General Public Licence (LGPL) version 3,        *
+ *                    copied verbatim in the file "LICENSE".                  *
+ *                                                                            *
+ * In applying this license GSI does not waive the privileges and immunities  *
+ * granted to it by virtue of its status as an Intergovernmental Organization *
+ * or submit itself to any jurisdiction.                                      *
+ ******************************************************************************/
+
+#include "R3BGTPCBackDriftMap.h"
+#include "R3BGTPCRandom.h"
+
+#include "FairLogger.h"
+#include "TFile.h"
+#include "TObjString.h"
+#include "TVectorD.h"
+#include "TVectorF.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <thread>
+
+namespace
+{
+    // First time node [ns]: the grid goes through the centers of the time
+    // buckets of R3BGTPCCalData, the times the hits look the table up at
+    Double_t FirstTime(const R3BGTPCHitEngine& engine, Double_t timeStep)
+    {
+        return std::fmod(0.5 * engine.GetParameters().fTimeBinSize, timeStep);
+    }
+} // namespace
+
+R3BGTPCBackDriftMap::R3BGTPCBackDriftMap()
+    : fKey("")
+{
+    for (Int_t c = 0; c < 3; c++)
+    {
+        fMin[c] = 0.;
+        fMax[c] = 0.;
+        fStep[c] = 0.;
+        fInvStep[c] = 0.;
+        fN[c] = 0;
+    }
+}
+
+void R3BGTPCBackDriftMap::SetGrid(const Double_t* min, const Double_t* step, const Int_t* n)
+{
+    for (Int_t c = 0; c < 3; c++)
+    {
+        fN[c] = std::max(n[c], 2);
+        fStep[c] = step[c];
+        fInvStep[c] = 1. / step[c];
+        fMin[c] = min[c];
+        fMax[c] = min[c] + (fN[c] - 1) * fStep[c];
+    }
+}
+
+TString R3BGTPCBackDriftMap::MakeKey(const R3BGTPCHitEngine& engine,
+                                     const R3BGTPCPadGeometry& padPlane,
+                                     Double_t maxTime,
+                                     Double_t timeStep)
+{
+    const auto& par = engine.GetParameters();
+    const auto& drift = engine.GetStepper()->GetParameters();
+    return TString::Format("v=%.9g DT=%.9g DL=%.9g E=%.9g dt=%.9g hy=%.9g hz=%.9g oz=%.9g angle=%.9g "
+                           "integrator=%d tol=%.6g par=%.6g pads=%dx%d pitch=%.6g tmax=%.6g tstep=%.6g t0=%.6g B=%.9g",
+                           drift.fDriftVelocity,
+                           drift.fTransDiff,
+                           drift.fLongDiff,
+                           drift.fDriftEField,
+                           drift.fDriftTimeStep,
+                           par.fHalfSizeTPC_Y,
+                           par.fHalfSizeTPC_Z,
+                           par.fFieldOffsetZ,
+                           par.fTargetAngle,
+                           (Int_t)engine.GetStepper()->GetIntegrator(),
+                           engine.GetStepper()->GetTolerance(),
+                           engine.GetStepper()->GetParallelTolerance(),
+                           padPlane.GetNColumns(),
+                           padPlane.GetNRows(),
+                           padPlane.GetPadSize(),
+                           maxTime,
+                           timeStep,
+                           FirstTime(engine, timeStep),
+                           engine.GetField()->GetChecksum());
+}
+
+TString R3BGTPCBackDriftMap::MakeFileName(const TString& dir, const TString& key)
+{
+    TString name = TString::Format("GTPCBackDriftMap_%08x.root", key.Hash());
+    if (dir.IsNull())
+        return name;
+    return dir.EndsWith("/") ? dir + name : dir + "/" + name;
+}
+
+void R3BGTPCBackDriftMap::Build(const R3BGTPCHitEngine& engine,
+                                const R3BGTPCPadGeometry& padPlane,
+                                Double_t maxTime,
+                                Double_t timeStep,
+                                Int_t nThreads)
+{
+    // Pad centers [cm] and drift times from the first bucket center to at least maxTime
+    Double_t pitch = padPlane.GetPadSize() / 10.;
+    Double_t firstTime = FirstTime(engine, timeStep);
+    Double_t min[3] = { 0.5 * pitch, 0.5 * pitch, firstTime };
+    Double_t step[3] = { pitch, pitch, timeStep };
+    Int_t n[3] = { padPlane.GetNColumns(),
+                   padPlane.GetNRows(),
+                   (Int_t)std::ceil((maxTime - firstTime) / timeStep) + 1 };
+    SetGrid(min, step, n);
+    fKey = MakeKey(engine, padPlane, maxTime, timeStep);
+    fTable.assign(kNQuantities * (size_t)fN[0] * fN[1] * fN[2], 0.);
+
+    std::vector<Double_t> times(fN[2]);
+    for (Int_t k = 0; k < fN[2]; k++)
+        times[k] = fMin[2] + k * fStep[2];
+
+    // All the times of a pad center are drifted back together, the columns
+    // are shared among the threads
+    if (nThreads <= 0)
+        nThreads = std::thread::hardware_concurrency();
+    nThreads = std::max(1, std::min(nThreads, fN[0]));
+    auto buildColumns = [&](Int_t t)
+    {
+        auto ws = engine.MakeWorkspace();
+        std::vector<Double_t> values(kNQuantities * fN[2]);
+        for (Int_t i = t; i < fN[0]; i += nThreads)
+        {
+            for (Int_t j = 0; j < fN[1]; j++)
+            {
+                Double_t z = fMin[0] + i * fStep[0];
+                Double_t x = fMin[1] + j * fStep[1];
+                engine.DriftBack(z, x, times.data(), fN[2], values.data(), *ws);
+                std::copy(values.begin(), values.end(), &fTable[kNQuantities * ((size_t)i * fN[1] + j) * fN[2]]);
+            }
+        }
+    };
+    if (nThreads == 1)
+    {
+        buildColumns(0);
+    }
+    else
+    {
+        std::vector<std::thread> workers;
+        workers.reserve(nThreads - 1);
+        for (Int_t t = 1; t < nThreads; t++)
+            workers.emplace_back(buildColumns, t);
+        buildColumns(0);
+        for (auto& worker : workers)
+            worker.join();
+    }
+
+    LOG(info) << "R3BGTPCBackDriftMap: built " << fN[0] << "x" << fN[1] << "x" << fN[2] << " nodes, time step "
+              << fStep[2] << " ns";
+}
+
+Double_t R3BGTPCBackDriftMap::Validate(const R3BGTPCHitEngine& engine, Int_t nSamples) const
+{
+    if (!IsReady() || nSamples <= 0)
+        return 0.;
+
+    // Times between the nodes, where the interpolation is the least accurate,
+    // at the pad centers only: the hits never look up other positions
+    R3BGTPCRandom rnd;
+    rnd.SetSeed(0, 0, 0);
+    auto ws = engine.MakeWorkspace();
+    Double_t stepped[kNQuantities], interpolated[kNQuantities];
+    Double_t maxDistance = 0., sumDistance = 0.;
+    for (Int_t s = 0; s < nSamples; s++)
+    {
+        Int_t i = std::min((Int_t)(rnd.Rndm() * fN[0]), fN[0] - 1);
+        Int_t j = std::min((Int_t)(rnd.Rndm() * fN[1]), fN[1] - 1);
+        Double_t z = fMin[0] + i * fStep[0];
+        Double_t x = fMin[1] + j * fStep[1];
+        Double_t time = fMin[2] + rnd.Rndm() * (fMax[2] - fMin[2]);
+
+        engine.DriftBack(z, x, &time, 1, stepped, *ws);
+        GetValues(z, x, time, interpolated);
+        Double_t distance = std::sqrt(std::pow(stepped[kX] - interpolated[kX], 2) +
+                                      std::pow(stepped[kY] - interpolated[kY], 2) +
+                                      std::pow(stepped[kZ] - interpolated[kZ], 2));
+        maxDistance = std::max(maxDistance, distance);
+        sumDistance += distance;
+    }
+
+    LOG(info) << "R3BGTPCBackDriftMap: distance to the stepped start points over " << nSamples
+              << " samples at pad centers, between time nodes: mean " << sumDistance / nSamples << " cm, max "
+              << maxDistance << " cm";
+    return maxDistance;
+}
+
+Bool_t R3BGTPCBackDriftMap::Write(const TString& fileName) const
+{
+    std::unique_ptr<TFile> file(TFile::Open(fileName, "RECREATE"));
+    if (!file || file->IsZombie())
+    {
+        LOG(warn) << "R3BGTPCBackDriftMap::Write: Could not open " << fileName;
+        return kFALSE;
+    }
+
+    TObjString key(fKey);
+    TVectorD grid(9);
+    for (Int_t c = 0; c < 3; c++)
+    {
+        grid[c] = fMin[c];
+        grid[3 + c] = fStep[c];
+        grid[6 + c] = fN[c];
+    }
+    TVectorF table((Int_t)fTable.size(), fTable.data());
+
+    key.Write("key");
+    grid.Write("grid");
+    table.Write("table");
+    file->Close();
+
+    LOG(info) << "R3BGTPCBackDriftMap: written to " << fileName;
+    return kTRUE;
+}
+
+Bool_t R3BGTPCBackDriftMap::Read(const TString& fileName, const TString& key)
+{
+    std::unique_ptr<TFile> file(TFile::Open(fileName, "READ"));
+    if (!file || file->IsZombie())
+        return kFALSE;
+
+    auto fileKey = dynamic_cast<TObjString*>(file->Get("key"));
+    auto grid = dynamic_cast<TVectorD*>(file->Get("grid"));
+    auto table = dynamic_cast<TVectorF*>(file->Get("table"));
+    if (!fileKey || !grid || !table || grid->GetNrows() != 9)
+    {
+        LOG(warn) << "R3BGTPCBackDriftMap::Read: " << fileName << " is not a GTPC back drift map";
+        return kFALSE;
+    }
+    if (fileKey->GetString() != key)
+    {
+        LOG(warn) << "R3BGTPCBackDriftMap::Read: " << fileName << " was built for different parameters";
+        return kFALSE;
+    }
+
+    Double_t min[3], step[3];
+    Int_t n[3];
+    for (Int_t c = 0; c < 3; c++)
+    {
+        min[c] = (*grid)[c];
+        step[c] = (*grid)[3 + c];
+        n[c] = (Int_t)(*grid)[6 + c];
+    }
+    SetGrid(min, step, n);
+    if ((size_t)table->GetNrows() != kNQuantities * (size_t)fN[0] * fN[1] * fN[2])
+    {
+        LOG(warn) << "R3BGTPCBackDriftMap::Read: " << fileName << " has an inconsistent size";
+        return kFALSE;
+    }
+    fTable.assign(table->GetMatrixArray(), table->GetMatrixArray() + table->GetNrows());
+    fKey = key;
+
+    LOG(info) << "R3BGTPCBackDriftMap: read from " << fileName;
+    return kTRUE;
+}
+
+Bool_t R3BGTPCBackDriftMap::IsInside(Double_t z, Double_t x, Double_t time) const
+{
+    return z >= fMin[0] && z <= fMax[0] && x >= fMin[1] && x <= fMax[1] && time >= fMin[2] && time <= fMax[2];
+}
+
+void R3BGTPCBackDriftMap::GetValues(Double_t z, Double_t x, Double_t time, Double_t* out) const
+{
+    Double_t u = (z - fMin[0]) * fInvStep[0];
+    Double_t v = (x - fMin[1]) * fInvStep[1];
+    Double_t w = (time - fMin[2]) * fInvStep[2];
+    Int_t i = std::max(0, std::min((Int_t)std::floor(u), fN[0] - 2));
+    Int_t j = std::max(0, std::min((Int_t)std::floor(v), fN[1] - 2));
+    Int_t k = std::max(0, std::min((Int_t)std::floor(w), fN[2] - 2));
+    Double_t fu = u - i;
+    Double_t fv = v - j;
+    Double_t fw = w - k;
+
+    const size_t st = kNQuantities;
+    const size_t sx = st * fN[2];
+    const size_t sz = sx * fN[1];
+    const Float_t* p = &fTable[i * sz + j * sx + k * st];
+
+    for (Int_t c = 0; c < kNQuantities; c++)
+    {
+        Double_t t00 = p[c] + fw * (p[st + c] - p[c]);
+        Double_t t10 = p[sx + c] + fw * (p[sx + st + c] - p[sx + c]);
+        Double_t t01 = p[sz + c] + fw * (p[sz + st + c] - p[sz + c]);
+        Double_t t11 = p[sz + sx + c] + fw * (p[sz + sx + st + c] - p[sz + sx + c]);
+        Double_t t0 = t00 + fv * (t10 - t00);
+        Double_t t1 = t01 + fv * (t11 - t01);
+        out[c] = t0 + fu * (t1 - t0);
+    }
+}
@@ -0,0 +1,113 @@
+/******************************************************************************
+ *   Copyright (C) 2018 GSI Helmholtzzentrum für Schwerionenforschung GmbH    *
+ *   Copyright (C) 2018-2025 Members of R3B Collaboration                     *
+ *                                                                            *
+ *             This software is distributed under the terms of the            *
+ *                 GNU Lesser General Public Licence (LGPL) version 3,        *
+ *                    copied verbatim in the file "LICENSE".                  *
+ *                                                                            *
+ * In applying this license GSI does not waive the privileges and immunities  *
+ * granted to it by virtue of its status as an Intergovernmental Organization *
+ * or submit itself to any jurisdiction.                                      *
+ ******************************************************************************/
+
+/**  R3BGTPCBackDriftMap.h
+ * Back drift correction table of R3BGTPCCal2Hit: for the center of each pad
+ * and a grid of drift times, the position the electrons started from and
+ * the widths of their cloud, obtained once with the Langevin stepper
+ **/
+
+#pragma once
+
+#include "R3BGTPCHitEngine.h"
+#include "R3BGTPCPadGeometry.h"
+#include "Rtypes.h"
+#include "TString.h"
+
+#include <vector>
+
+/**
+ * GTPC back drift map
+ *
+ * The nodes are the pad centers (z, x) [cm] on the pad plane, in the frame
+ * of R3BGTPCPadGeometry, times a regular grid of drift times [ns] through
+ * the centers of the time buckets. Each node holds (kX, kY, kZ, kSigmaLong,
+ * kSigmaTransv): the start point of the drift in the TPC frame [cm] and the
+ * longitudinal and transversal widths [cm] of the cloud, as given by
+ * R3BGTPCHitEngine::DriftBack. Values between nodes are obtained by
+ * trilinear interpolation. The hits look the table up at the pad centers and
+ * bucket centers only, so with the default time spacing of one bucket every
+ * lookup falls on a node and nothing is interpolated.
+ *
+ * As R3BGTPCDriftMap, the table is written to a file named after the
+ * settings it depends on (see MakeKey) and read back by later runs with the
+ * same settings.
+ */
+
+class R3BGTPCBackDriftMap
+{
+  public:
+    enum Quantity
+    {
+        kX = 0,
+        kY,
+        kZ,
+        kSigmaLong,
+        kSigmaTransv,
+        kNQuantities
+    };
+
+    /** Default constructor **/
+    R3BGTPCBackDriftMap();
+
+    /** Destructor **/
+    ~R3BGTPCBackDriftMap() = default;
+
+    /** Fill the table drifting back with engine from every pad center of
+     ** padPlane up to maxTime [ns] every timeStep [ns], with the nodes on
+     ** the bucket centers, in nThreads threads (0 all cores) **/
+    void Build(const R3BGTPCHitEngine& engine,
+               const R3BGTPCPadGeometry& padPlane,
+               Double_t maxTime,
+               Double_t timeStep,
+               Int_t nThreads = 0);
+
+    /** Largest distance [cm] between the interpolated start points and the
+     ** ones drifted back with engine, for nSamples random times at random
+     ** pad centers. Only the time interpolation is checked, as the hits only
+     ** look the table up at the pad centers **/
+    Double_t Validate(const R3BGTPCHitEngine& engine, Int_t nSamples) const;
+
+    /** Persistency, the key must match for a file to be accepted **/
+    Bool_t Write(const TString& fileName) const;
+    Bool_t Read(const TString& fileName, const TString& key);
+
+    /** Unique description of the settings the table depends on **/
+    static TString MakeKey(const R3BGTPCHitEngine& engine,
+                           const R3BGTPCPadGeometry& padPlane,
+                           Double_t maxTime,
+                           Double_t timeStep);
+
+    /** File name derived from the key, in directory dir **/
+    static TString MakeFileName(const TString& dir, const TString& key);
+
+    /** True if (z,x) [cm] on the pad plane and time [ns] are covered by the table **/
+    Bool_t IsInside(Double_t z, Double_t x, Double_t time) const;
+
+    /** Interpolated values for (z,x) [cm] on the pad plane and time [ns] in out[kNQuantities] **/
+    void GetValues(Double_t z, Double_t x, Double_t time, Double_t* out) const;
+
+    const TString& GetKey() const { return fKey; }
+    Bool_t IsReady() const { return !fTable.empty(); }
+
+  private:
+    TString fKey;                //!< Settings the table was built for
+    Double_t fMin[3];            //!< First node in z, x [cm] and time [ns]
+    Double_t fMax[3];            //!< Last node in z, x [cm] and time [ns]
+    Double_t fStep[3];           //!< Node spacing in z, x [cm] and time [ns]
+    Double_t fInvStep[3];        //!< 1/fStep
+    Int_t fN[3];                 //!< Number of nodes in z, x and time
+    std::vector<Float_t> fTable; //!< kNQuantities values per node, time running fastest, then x
+
+    void SetGrid(const Double_t* min, const Double_t* step, const Int_t* n);
+};
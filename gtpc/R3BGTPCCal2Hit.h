@@ -14,12 +14,17 @@
 #pragma once
 
 #include "FairTask.h"
+#include "R3BGTPCBackDriftMap.h"
 #include "R3BGTPCCalData.h"
+#include "R3BGTPCDriftStepper.h"
 #include "R3BGTPCElecPar.h"
+#include "R3BGTPCFieldCache.h"
 #include "R3BGTPCGasPar.h"
 #include "R3BGTPCGeoPar.h"
 #include "R3BGTPCHitData.h"
-#include "R3BGTPCMap.h"
+#include "R3BGTPCHitEngine.h"
+#include "R3BGTPCPadGeometry.h"
+#include "R3BGTPCPipeline.h"
 
 class TClonesArray;
 
@@ -35,6 +40,10 @@ class R3BGTPCCal2Hit : public FairTask
     /** Virtual method Exec **/
     virtual void Exec(Option_t* opt);
 
+    /** Exec on the arrays of an event of R3BGTPCPipeline: GTPCCalData and
+     ** the GTPCHitData output **/
+    void ExecEvent(R3BGTPCPipelineEvent& event);
+
     /** Virtual method Reset **/
     virtual void Reset();
 
@@ -54,12 +63,35 @@ class R3BGTPCCal2Hit : public FairTask
     void SetOnline(Bool_t option) { fOnline = option; }
     void SetRecoFlag(Bool_t BooleanFlag) { fLangevinBack = BooleanFlag; }
 
-    typedef boost::multi_array<double, 3> multiarray;
-    typedef multiarray::index index;
-    multiarray PadCoordArr;
+    /** Integrator of the drift. With R3BGTPCDriftStepper::kRK45 the drift time
+     ** step is the largest step and tolerance the position error per step [cm] **/
+    void SetDriftIntegrator(R3BGTPCDriftStepper::EIntegrator integrator, Double_t tolerance = 1e-4)
+    {
+        fIntegrator = integrator;
+        fIntegratorTolerance = tolerance;
+    }
+
+    /** Drift in a single closed-form step where |B_x|,|B_z| < tolerance*|B_y|
+     ** along the whole path of the electron. Default 0 (always step) **/
+    void SetParallelFieldTolerance(Double_t tolerance) { fParallelTolerance = tolerance; }
+
+    /** Back drift from a R3BGTPCBackDriftMap, one lookup per sample instead of
+     ** stepping. The map covers every pad center and drift times every
+     ** step [ns] (0 the time bin size) up to the full drift length, later
+     ** samples are drifted back step by step; it is written to the directory
+     ** and read back by the runs with the same settings **/
+    void SetBackDriftMapMode(Bool_t mode) { fUseBackDriftMap = mode; }
+    void SetBackDriftMapDir(TString dir) { fBackDriftMapDir = dir; }
+    void SetBackDriftMapTimeStep(Double_t step) { fBackDriftMapTimeStep = step; }
+
+    /** Hit making kernel built in Init/ReInit. It can be shared with other
+     ** threads making the hits of their own events, each with its own workspace **/
+    const R3BGTPCHitEngine* GetEngine() const { return fEngine.get(); }
 
   private:
     void SetParameter();
+    R3BGTPCDriftParameters GetDriftParameters() const;
+    R3BGTPCHitEngine::Parameters GetEngineParameters() const;
 
     Double_t fEIonization;      //!< Effective ionization energy of gas [GeV]
     Double_t fDriftVelocity;    //!< Drift velocity in gas [cm/ns]
@@ -90,7 +122,11 @@ class R3BGTPCCal2Hit : public FairTask
 
     TClonesArray* fCalCA;
     TClonesArray* fHitCA;
-    std::shared_ptr<R3BGTPCMap> fTPCMap;
+    std::shared_ptr<const R3BGTPCPadGeometry> fPadGeometry;  //!< Pad plane geometry
+    std::shared_ptr<R3BGTPCFieldCache> fFieldCache;          //!< GLAD field resampled over the drift volume
+    std::shared_ptr<R3BGTPCDriftStepper> fStepper;           //!< Langevin stepper for the back drift
+    std::unique_ptr<R3BGTPCHitEngine> fEngine;               //!< Hit making kernel of the current parameters
+    std::unique_ptr<R3BGTPCHitEngine::Workspace> fWorkspace; //!< Memory of the events of this task
 
     Bool_t fOnline; // Selector for online data storage
 
@@ -98,9 +134,21 @@ class R3BGTPCCal2Hit : public FairTask
     // True: Reconstruction with Langevin equations
     // False: Reconstruction already done
 
-    /** Private method AddHitData**/
-    //** Adds a Hit to the HitCollection
-    R3BGTPCHitData* AddHitData(Double_t x, Double_t y, Double_t z, Double_t longWidth, Double_t energy);
+    R3BGTPCDriftStepper::EIntegrator fIntegrator; //!< Back drift integrator. Default kEuler
+    Double_t fIntegratorTolerance;                //!< Position error per step for kRK45 [cm]
+    Double_t fParallelTolerance;                  //!< Largest |B_transv|/|B_y| of the closed-form drift
+
+    Bool_t fUseBackDriftMap;                            //!< Lookup-table back drift, no stepping. Default kFALSE
+    TString fBackDriftMapDir;                           //!< Directory of the back drift map files. Default "."
+    Double_t fBackDriftMapTimeStep;                     //!< Time spacing of the back drift map [ns]. Default 0
+    std::shared_ptr<R3BGTPCBackDriftMap> fBackDriftMap; //!< Back drift map, if in lookup mode
+
+    /** Back drift map of the current parameters and field: reused, read or
+     ** built, and checked against the stepped back drift **/
+    InitStatus InitBackDriftMap();
+
+    /** Engine (and workspace) for the current parameters and field **/
+    void InitEngine();
 
     ClassDef(R3BGTPCCal2Hit, 1);
 };
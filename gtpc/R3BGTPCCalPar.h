@@ -47,6 +47,10 @@ class R3BGTPCCalPar : public FairParGenericSet
     virtual void print();
     void printParams();
 
+    /** Calibration parameters of each pad, one pad after the other in
+     ** GTPCCalPar: pedestal [ADC], gain, time offset [time buckets] **/
+    static constexpr Int_t kParamsPerPad = 3;
+
     /** Accessor functions **/
     const Double_t GetNumParams() { return fNumParams; }
     TArrayF* GetCalParams() { return fCalParams; }
@@ -0,0 +1,299 @@
+/******************************************************************************
+ *   Copyright (C) 2018 GSI Helmholtzzentrum für Schwerionenforschung GmbH    *
+ *   Copyright (C) 2018-2025 Members of R3B Collaboration                     *
+ *                                                                            *
+ *             This software is distributed under the terms of the            *
+ *                 GNU Lesser General Public Licence (LGPL) version 3,        *
+ *                    copied verbatim in the file "LICENSE".                  *
+ *                                                                            *
+ * In applying this license GSI does not waive the privileges and immunities  *
+ * granted to it by virtue of its status as an Intergovernmental Organization *
+ * or submit itself to any jurisdiction.                                      *
+ ******************************************************************************/
+
+#include "R3BGTPCCalibrationEngine.h"
+#include "R3BGTPCCalData.h"
+#include "R3BGTPCCalPar.h"
+#include "R3BGTPCMappedData.h"
+
+#include "FairLogger.h"
+#include "TClonesArray.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace
+{
+    // out[b] = (adc[b] - pedestal) * gain for b in [0, n)
+    void SubtractAndScale(const UShort_t* adc, Int_t n, Float_t pedestal, Float_t gain, Float_t* out)
+    {
+        Int_t b = 0;
+#if defined(__AVX512F__)
+        const __m512 vPedestal = _mm512_set1_ps(pedestal);
+        const __m512 vGain = _mm512_set1_ps(gain);
+        for (; b + 16 <= n; b += 16)
+        {
+            __m512i raw = _mm512_cvtepu16_epi32(_mm256_loadu_si256((const __m256i*)(adc + b)));
+            _mm512_storeu_ps(out + b, _mm512_mul_ps(_mm512_sub_ps(_mm512_cvtepi32_ps(raw), vPedestal), vGain));
+        }
+#elif defined(__AVX2__)
+        const __m256 vPedestal = _mm256_set1_ps(pedestal);
+        const __m256 vGain = _mm256_set1_ps(gain);
+        for (; b + 8 <= n; b += 8)
+        {
+            __m256i raw = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)(adc + b)));
+            _mm256_storeu_ps(out + b, _mm256_mul_ps(_mm256_sub_ps(_mm256_cvtepi32_ps(raw), vPedestal), vGain));
+        }
+#endif
+        for (; b < n; b++)
+            out[b] = (adc[b] - pedestal) * gain;
+    }
+
+    // out[b] = (1 - w) * in[b + shift] + w * in[b + shift + 1], rounded to
+    // nearest and clamped to [0, kMaxUShort], for b in [first, last)
+    void InterpolateAndRound(const Float_t* in, Int_t shift, Float_t w, Int_t first, Int_t last, UShort_t* out)
+    {
+        const Float_t w0 = 1.f - w;
+        const Float_t max = kMaxUShort;
+        Int_t b = first;
+#if defined(__AVX512F__)
+        const __m512 vW0 = _mm512_set1_ps(w0);
+        const __m512 vW1 = _mm512_set1_ps(w);
+        const __m512 vZero = _mm512_setzero_ps();
+        const __m512 vMax = _mm512_set1_ps(max);
+        for (; b + 16 <= last; b += 16)
+        {
+            __m512 v = _mm512_add_ps(_mm512_mul_ps(vW0, _mm512_loadu_ps(in + b + shift)),
+                                     _mm512_mul_ps(vW1, _mm512_loadu_ps(in + b + shift + 1)));
+            v = _mm512_min_ps(_mm512_max_ps(v, vZero), vMax);
+            _mm256_storeu_si256((__m256i*)(out + b), _mm512_cvtepi32_epi16(_mm512_cvtps_epi32(v)));
+        }
+#elif defined(__AVX2__)
+        const __m256 vW0 = _mm256_set1_ps(w0);
+        const __m256 vW1 = _mm256_set1_ps(w);
+        const __m256 vZero = _mm256_setzero_ps();
+        const __m256 vMax = _mm256_set1_ps(max);
+        for (; b + 8 <= last; b += 8)
+        {
+            __m256 v = _mm256_add_ps(_mm256_mul_ps(vW0, _mm256_loadu_ps(in + b + shift)),
+                                     _mm256_mul_ps(vW1, _mm256_loadu_ps(in + b + shift + 1)));
+            v = _mm256_min_ps(_mm256_max_ps(v, vZero), vMax);
+            __m256i rounded = _mm256_cvtps_epi32(v);
+            _mm_storeu_si128((__m128i*)(out + b),
+                             _mm_packus_epi32(_mm256_castsi256_si128(rounded), _mm256_extracti128_si256(rounded, 1)));
+        }
+#endif
+        for (; b < last; b++)
+        {
+            Float_t v = std::min(std::max(w0 * in[b + shift] + w * in[b + shift + 1], 0.f), max);
+            out[b] = (UShort_t)std::nearbyint(v);
+        }
+    }
+
+    // Signal windows of the running baseline when no threshold is set [noise RMS]
+    constexpr Float_t kSignalThreshold = 5.;
+    // Signal-free samples needed to update the running baseline of a pad
+    constexpr Int_t kMinBaselineSamples = 16;
+} // namespace
+
+R3BGTPCCalibrationEngine::R3BGTPCCalibrationEngine(const Parameters& par)
+    : fPar(par)
+{
+    if (fPar.fGain.size() != fPar.fPedestal.size() || fPar.fTimeOffset.size() != fPar.fPedestal.size())
+        LOG(fatal) << "R3BGTPCCalibrationEngine: Calibration arrays of different sizes";
+}
+
+R3BGTPCCalibrationEngine::Parameters R3BGTPCCalibrationEngine::ReadParameters(R3BGTPCCalPar* calPar)
+{
+    Parameters par;
+    if (!calPar || !calPar->GetCalParams())
+        return par;
+
+    const TArrayF* values = calPar->GetCalParams();
+    Int_t nValues = std::min<Int_t>(calPar->GetNumParams(), values->GetSize());
+    if (nValues % R3BGTPCCalPar::kParamsPerPad != 0)
+        LOG(warn) << "R3BGTPCCalibrationEngine: " << nValues << " values in GTPCCalPar, not "
+                  << R3BGTPCCalPar::kParamsPerPad << " per pad";
+
+    Int_t nPads = nValues / R3BGTPCCalPar::kParamsPerPad;
+    par.fPedestal.resize(nPads);
+    par.fGain.resize(nPads);
+    par.fTimeOffset.resize(nPads);
+    for (Int_t pad = 0; pad < nPads; pad++)
+    {
+        Int_t first = pad * R3BGTPCCalPar::kParamsPerPad;
+        par.fPedestal[pad] = values->GetAt(first);
+        par.fGain[pad] = values->GetAt(first + 1);
+        par.fTimeOffset[pad] = values->GetAt(first + 2);
+    }
+    return par;
+}
+
+void R3BGTPCCalibrationEngine::Calibrate(const TClonesArray& mapped, TClonesArray& cal, Workspace& ws) const
+{
+    Int_t nMapped = mapped.GetEntriesFast();
+    for (Int_t i = 0; i < nMapped; i++)
+    {
+        auto mappedData = (R3BGTPCMappedData*)mapped.At(i);
+        if (!mappedData->IsValid())
+            continue;
+
+        mappedData->GetADC(ws.raw);
+        Int_t pad = mappedData->GetPadId();
+        if (!CalibrateTrace(pad, ws.raw.data(), ws.raw.size(), mappedData->IsPedestalSubtracted(), ws))
+            continue;
+
+        auto calData = (R3BGTPCCalData*)cal.ConstructedAt(cal.GetEntriesFast());
+        calData->Set(pad, ws.adc, fPar.fZeroSuppress);
+    }
+}
+
+Bool_t R3BGTPCCalibrationEngine::CalibrateTrace(Int_t pad,
+                                                const UShort_t* adc,
+                                                Int_t nBuckets,
+                                                Bool_t pedestalSubtracted,
+                                                Workspace& ws) const
+{
+    Float_t pedestal = 0.f, gain = 1.f, timeOffset = 0.f;
+    if (pad >= 0 && pad < GetNumberOfPads())
+    {
+        pedestal = pedestalSubtracted ? 0.f : fPar.fPedestal[pad];
+        gain = fPar.fGain[pad];
+        timeOffset = fPar.fTimeOffset[pad];
+    }
+
+    // trace[0] and trace[nBuckets + 1] are the zeros beyond both ends
+    ws.trace.resize(nBuckets + 2);
+    ws.trace[0] = 0.f;
+    ws.trace[nBuckets + 1] = 0.f;
+    SubtractAndScale(adc, nBuckets, pedestal, gain, ws.trace.data() + 1);
+
+    ws.nSamples += nBuckets;
+    if (fPar.fRunningBaseline)
+    {
+        Int_t kept = SubtractBaseline(pad, ws.trace.data() + 1, nBuckets, pedestalSubtracted, ws);
+        ws.nSamplesKept += kept;
+        if (kept == 0 && fPar.fThreshold > 0.)
+            return kFALSE;
+    }
+    else
+        ws.nSamplesKept += nBuckets;
+
+    // out[b] = c(b + timeOffset) = trace[b + shift] and trace[b + shift + 1]
+    Int_t k = (Int_t)std::floor(timeOffset);
+    Float_t w = timeOffset - k;
+    Int_t shift = k + 1;
+    Int_t first = std::clamp(-shift, 0, nBuckets);
+    Int_t last = std::clamp(nBuckets - k, first, nBuckets);
+
+    ws.adc.resize(nBuckets);
+    std::fill(ws.adc.begin(), ws.adc.begin() + first, 0);
+    std::fill(ws.adc.begin() + last, ws.adc.end(), 0);
+    InterpolateAndRound(ws.trace.data(), shift, w, first, last, ws.adc.data());
+    return kTRUE;
+}
+
+Float_t R3BGTPCCalibrationEngine::GetThreshold(Float_t nSigma, Float_t variance)
+{
+    // at least one ADC count, for pads without noise
+    return std::max(nSigma * std::sqrt(variance), 1.f);
+}
+
+Int_t R3BGTPCCalibrationEngine::SubtractBaseline(Int_t pad,
+                                                 Float_t* c,
+                                                 Int_t nBuckets,
+                                                 Bool_t pedestalSubtracted,
+                                                 Workspace& ws) const
+{
+    if (pad < 0 || nBuckets == 0)
+        return nBuckets;
+    if (pad >= (Int_t)ws.nEvents.size())
+    {
+        ws.baseline.resize(pad + 1, 0.f);
+        ws.variance.resize(pad + 1, 0.f);
+        ws.nEvents.resize(pad + 1, 0);
+    }
+
+    // First trace of the pad: median and MAD, robust against the signal
+    if (ws.nEvents[pad] == 0)
+    {
+        ws.scratch.assign(c, c + nBuckets);
+        auto middle = ws.scratch.begin() + nBuckets / 2;
+        std::nth_element(ws.scratch.begin(), middle, ws.scratch.end());
+        Float_t median = pedestalSubtracted ? 0.f : *middle;
+        for (auto& value : ws.scratch)
+            value = std::fabs(value - median);
+        std::nth_element(ws.scratch.begin(), middle, ws.scratch.end());
+        ws.baseline[pad] = median;
+        ws.variance[pad] = (1.4826f * *middle) * (1.4826f * *middle);
+    }
+
+    const Float_t baseline = pedestalSubtracted ? 0.f : ws.baseline[pad];
+    const Float_t threshold =
+        GetThreshold(fPar.fThreshold > 0. ? fPar.fThreshold : kSignalThreshold, ws.variance[pad]);
+    for (Int_t b = 0; b < nBuckets; b++)
+        c[b] -= baseline;
+
+    // Windows around the samples over threshold: forward for the samples
+    // after, backward for the samples before
+    ws.keep.assign(nBuckets, 0);
+    for (Int_t b = 0, lastOver = -fPar.fPostSamples - 1; b < nBuckets; b++)
+    {
+        if (c[b] > threshold)
+            lastOver = b;
+        ws.keep[b] = b - lastOver <= fPar.fPostSamples;
+    }
+    for (Int_t b = nBuckets - 1, nextOver = nBuckets + fPar.fPreSamples; b >= 0; b--)
+    {
+        if (c[b] > threshold)
+            nextOver = b;
+        ws.keep[b] |= nextOver - b <= fPar.fPreSamples;
+    }
+
+    // Running values from the signal-free samples
+    Double_t sum = 0., sum2 = 0.;
+    Int_t nFree = 0;
+    for (Int_t b = 0; b < nBuckets; b++)
+        if (!ws.keep[b])
+        {
+            sum += c[b];
+            sum2 += c[b] * c[b];
+            nFree++;
+        }
+    if (nFree >= kMinBaselineSamples)
+    {
+        Double_t mean = sum / nFree;
+        Double_t variance = pedestalSubtracted ? sum2 / nFree : sum2 / nFree - mean * mean;
+        Float_t weight = std::max(fPar.fBaselineWeight, 1.f / (ws.nEvents[pad] + 1));
+        if (!pedestalSubtracted)
+            ws.baseline[pad] += weight * mean;
+        ws.variance[pad] += weight * (variance - ws.variance[pad]);
+        ws.nEvents[pad]++;
+    }
+
+    if (fPar.fThreshold <= 0.)
+        return nBuckets;
+
+    Int_t kept = 0;
+    for (Int_t b = 0; b < nBuckets; b++)
+    {
+        c[b] = ws.keep[b] ? c[b] : 0.f;
+        kept += ws.keep[b];
+    }
+    return kept;
+}
+
+const char* R3BGTPCCalibrationEngine::GetInstructionSet()
+{
+#if defined(__AVX512F__)
+    return "AVX-512";
+#elif defined(__AVX2__)
+    return "AVX2";
+#else
+    return "scalar";
+#endif
+}
@@ -0,0 +1,141 @@
+/******************************************************************************
+ *   Copyright (C) 2018 GSI Helmholtzzentrum für Schwerionenforschung GmbH    *
+ *   Copyright (C) 2018-2025 Members of R3B Collaboration                     *
+ *                                                                            *
+ *             This software is distributed under the terms of the            *
+ *                 GNU Lesser General Public Licence (LGPL) version 3,        *
+ *                    copied verbatim in the file "LICENSE".                  *
+ *                                                                            *
+ * In applying this license GSI does not waive the privileges and immunities  *
+ * granted to it by virtue of its status as an Intergovernmental Organization *
+ * or submit itself to any jurisdiction.                                      *
+ ******************************************************************************/
+
+/**  R3BGTPCCalibrationEngine.h
+ * Calibration kernel of R3BGTPCMapped2Cal: pedestal subtraction, gain
+ * equalization, running baseline, zero suppression and time offset
+ * correction of the traces of the pads
+ **/
+
+#pragma once
+
+#include "Rtypes.h"
+
+#include <memory>
+#include <vector>
+
+class R3BGTPCCalPar;
+class TClonesArray;
+
+/**
+ * GTPC calibration engine
+ *
+ * The calibration of each pad is held in flat arrays indexed by pad, read
+ * once from R3BGTPCCalPar. A trace is calibrated in two vector loops over its
+ * time buckets (AVX-512 or AVX2 if the build enables them):
+ *
+ *   c[b]   = (adc[b] - pedestal) * gain
+ *   out[b] = c(b + timeOffset), linearly interpolated, rounded and clamped
+ *            to [0, kMaxUShort]
+ *
+ * so a pad whose electronics lag by timeOffset buckets is moved back in
+ * time. Pads beyond the arrays are left uncalibrated (pedestal 0, gain 1,
+ * offset 0).
+ *
+ * With fRunningBaseline the baseline left in c and the noise RMS of each pad
+ * are followed from event to event and the baseline is subtracted before the
+ * time offset correction. The signal-free samples of a trace are the ones
+ * outside the windows of fPreSamples before and fPostSamples after each
+ * sample over threshold; they update the running values with weight
+ * fBaselineWeight (a plain mean over the first events). The first trace of a
+ * pad starts them from its median and median absolute deviation. Data
+ * flagged as pedestal subtracted keeps a zero baseline, only its noise is
+ * followed. With fThreshold the samples outside the windows are set to zero
+ * and the pads without any sample over threshold are dropped.
+ *
+ * Like the other GTPC engines the methods are const and what changes from
+ * event to event lives in a Workspace, one per event stream.
+ */
+
+class R3BGTPCCalibrationEngine
+{
+  public:
+    /** Values of the parameter container and task settings used per event **/
+    struct Parameters
+    {
+        std::vector<Float_t> fPedestal;   //!< Pedestal of each pad [ADC]
+        std::vector<Float_t> fGain;       //!< Gain equalization factor of each pad
+        std::vector<Float_t> fTimeOffset; //!< Time offset of each pad [time buckets]
+        Bool_t fZeroSuppress = kTRUE;     //!< Zero suppressed R3BGTPCCalData
+        Bool_t fRunningBaseline = kFALSE; //!< Running baseline subtraction and noise estimation
+        Float_t fBaselineWeight = 0.05;   //!< Weight of an event in the running baseline and noise
+        Float_t fThreshold = 0.;          //!< Zero suppression threshold [noise RMS], 0 keeps all samples
+        Int_t fPreSamples = 2;            //!< Samples kept before a sample over threshold
+        Int_t fPostSamples = 4;           //!< Samples kept after a sample over threshold
+    };
+
+    /** Memory of an event stream, reused from one event to the next **/
+    struct Workspace
+    {
+        std::vector<UShort_t> raw;  //!< Dense trace of the R3BGTPCMappedData
+        std::vector<Float_t> trace; //!< Pedestal subtracted and scaled trace, with a zero bucket at each end
+        std::vector<UShort_t> adc;  //!< Calibrated trace
+
+        // Running statistics of the pads seen by the stream, indexed by pad
+        std::vector<Float_t> baseline; //!< Baseline left after the pedestal [calibrated ADC]
+        std::vector<Float_t> variance; //!< Noise variance [calibrated ADC^2]
+        std::vector<UInt_t> nEvents;   //!< Events in the running values, 0 not started
+
+        std::vector<UChar_t> keep;    //!< Samples of the trace in a window over threshold
+        std::vector<Float_t> scratch; //!< Copy of the trace for the first median
+        Long64_t nSamples = 0;        //!< Samples calibrated
+        Long64_t nSamplesKept = 0;    //!< Samples left after the zero suppression
+    };
+
+    /** Constructor
+     *@param par        Parameters, copied
+     **/
+    explicit R3BGTPCCalibrationEngine(const Parameters& par);
+
+    /** Destructor **/
+    ~R3BGTPCCalibrationEngine() = default;
+
+    /** Parameters of the pads in calPar, as kParamsPerPad values per pad
+     ** (see R3BGTPCCalPar). Empty arrays if calPar is nullptr **/
+    static Parameters ReadParameters(R3BGTPCCalPar* calPar);
+
+    /** New workspace for an event stream **/
+    std::unique_ptr<Workspace> MakeWorkspace() const { return std::make_unique<Workspace>(); }
+
+    /** Add to cal (R3BGTPCCalData) one calibrated trace per valid
+     ** R3BGTPCMappedData of mapped. The objects of cal are reused as a pool:
+     ** cal must be cleared without the "C" option between events **/
+    void Calibrate(const TClonesArray& mapped, TClonesArray& cal, Workspace& ws) const;
+
+    /** Calibrate the nBuckets of adc of pad into ws.adc. The pedestal is
+     ** not subtracted if pedestalSubtracted. kFALSE if no sample is over
+     ** threshold, then ws.adc is not filled **/
+    Bool_t CalibrateTrace(Int_t pad,
+                          const UShort_t* adc,
+                          Int_t nBuckets,
+                          Bool_t pedestalSubtracted,
+                          Workspace& ws) const;
+
+    const Parameters& GetParameters() const { return fPar; }
+    Int_t GetNumberOfPads() const { return fPar.fPedestal.size(); }
+
+    /** Instruction set of the calibration loops **/
+    static const char* GetInstructionSet();
+
+    /** Threshold over the baseline of a pad [calibrated ADC] for the given
+     ** number of noise RMS **/
+    static Float_t GetThreshold(Float_t nSigma, Float_t variance);
+
+  private:
+    const Parameters fPar; //!< Parameters
+
+    /** Running baseline and noise of pad from the trace c of nBuckets, which
+     ** is baseline subtracted and, with a threshold, zero suppressed. Returns
+     ** the number of samples kept **/
+    Int_t SubtractBaseline(Int_t pad, Float_t* c, Int_t nBuckets, Bool_t pedestalSubtracted, Workspace& ws) const;
+};
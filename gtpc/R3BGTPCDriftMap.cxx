@@ -0,0 +1,227 @@
+/******************************************************************************
+ *   Copyright (C) 2018 GSI Helmholtzzentrum für Schwerionenforschung GmbH    *
+ *   Copyright (C) 2018-2025 Members of R3B Collaboration                     *
+ *                                                                            *
+ *             This software is distributed under the terms of the            *
+ *                 GNU Lesser General Public Licence (LGPL) version 3,        *
+ *                    copied verbatim in the file "LICENSE".                  *
+ *                                                                            *
+ * In applying this license GSI does not waive the privileges and immunities  *
+ * granted to it by virtue of its status as an Intergovernmental Organization *
+ * or submit itself to any jurisdiction.                                      *
+ ******************************************************************************/
+
+#include "R3BGTPCDriftMap.h"
+
+#include "FairLogger.h"
+#include "TFile.h"
+#include "TObjString.h"
+#include "TVectorD.h"
+#include "TVectorF.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+
+R3BGTPCDriftMap::R3BGTPCDriftMap()
+    : fKey("")
+    , fStep(0.)
+    , fInvStep(0.)
+{
+    for (Int_t c = 0; c < 3; c++)
+    {
+        fMin[c] = 0.;
+        fMax[c] = 0.;
+        fN[c] = 0;
+    }
+}
+
+void R3BGTPCDriftMap::SetGrid(const Double_t* min, const Double_t* max, Double_t step)
+{
+    fStep = step;
+    fInvStep = 1. / step;
+    for (Int_t c = 0; c < 3; c++)
+    {
+        fN[c] = (Int_t)std::ceil((max[c] - min[c]) * fInvStep) + 1;
+        if (fN[c] < 2)
+            fN[c] = 2;
+        fMin[c] = min[c];
+        fMax[c] = min[c] + (fN[c] - 1) * fStep;
+    }
+}
+
+TString R3BGTPCDriftMap::MakeKey(const R3BGTPCDriftStepper& stepper,
+                                 const Double_t* min,
+                                 const Double_t* max,
+                                 Double_t step)
+{
+    const R3BGTPCDriftParameters& par = stepper.GetParameters();
+    return TString::Format("v=%.9g DT=%.9g DL=%.9g E=%.9g dt=%.9g hy=%.9g min=(%.6g,%.6g,%.6g) max=(%.6g,%.6g,%.6g) "
+                           "step=%.6g integrator=%d tol=%.6g par=%.6g B=%.9g",
+                           par.fDriftVelocity,
+                           par.fTransDiff,
+                           par.fLongDiff,
+                           par.fDriftEField,
+                           par.fDriftTimeStep,
+                           par.fHalfSizeTPC_Y,
+                           min[0],
+                           min[1],
+                           min[2],
+                           max[0],
+                           max[1],
+                           max[2],
+                           step,
+                           (Int_t)stepper.GetIntegrator(),
+                           stepper.GetTolerance(),
+                           stepper.GetParallelTolerance(),
+                           stepper.GetFieldCache()->GetChecksum());
+}
+
+TString R3BGTPCDriftMap::MakeFileName(const TString& dir, const TString& key)
+{
+    TString name = TString::Format("GTPCDriftMap_%08x.root", key.Hash());
+    if (dir.IsNull())
+        return name;
+    return dir.EndsWith("/") ? dir + name : dir + "/" + name;
+}
+
+void R3BGTPCDriftMap::Build(const R3BGTPCDriftStepper& stepper,
+                            const Double_t* min,
+                            const Double_t* max,
+                            Double_t step)
+{
+    SetGrid(min, max, step);
+    fKey = MakeKey(stepper, min, max, step);
+    fTable.assign(kNQuantities * (size_t)fN[0] * fN[1] * fN[2], 0.);
+
+    // The mean electron of every node of a z slice is drifted at once, with
+    // the integrator and closed-form settings of the simulation
+    R3BGTPCDriftStepper::Electrons ele;
+    size_t node = 0;
+    for (Int_t k = 0; k < fN[2]; k++)
+    {
+        ele.Clear();
+        for (Int_t j = 0; j < fN[1]; j++)
+            for (Int_t i = 0; i < fN[0]; i++)
+                ele.Add(fMin[0] + i * fStep, fMin[1] + j * fStep, fMin[2] + k * fStep, 0.);
+        stepper.DriftForwardMean(ele);
+
+        for (Int_t e = 0; e < ele.GetSize(); e++)
+        {
+            Double_t y0 = fMin[1] + (e / fN[0]) * fStep;
+            Double_t meanVy = ele.t[e] > 0. ? (y0 - ele.y[e]) / ele.t[e] : 0.;
+            fTable[node + kX] = ele.x[e];
+            fTable[node + kZ] = ele.z[e];
+            fTable[node + kTime] = ele.t[e];
+            fTable[node + kSigmaTransv] = sqrt(ele.varTransv[e]);
+            // longitudinal spread [cm] -> [ns]
+            fTable[node + kSigmaTime] = meanVy > 0. ? sqrt(ele.varLong[e]) / meanVy : 0.;
+            node += kNQuantities;
+        }
+    }
+
+    LOG(info) << "R3BGTPCDriftMap: built " << fN[0] << "x" << fN[1] << "x" << fN[2] << " nodes (step " << fStep
+              << " cm)";
+}
+
+Bool_t R3BGTPCDriftMap::Write(const TString& fileName) const
+{
+    std::unique_ptr<TFile> file(TFile::Open(fileName, "RECREATE"));
+    if (!file || file->IsZombie())
+    {
+        LOG(warn) << "R3BGTPCDriftMap::Write: Could not open " << fileName;
+        return kFALSE;
+    }
+
+    TObjString key(fKey);
+    TVectorD grid(7);
+    for (Int_t c = 0; c < 3; c++)
+    {
+        grid[c] = fMin[c];
+        grid[3 + c] = fN[c];
+    }
+    grid[6] = fStep;
+    TVectorF table((Int_t)fTable.size(), fTable.data());
+
+    key.Write("key");
+    grid.Write("grid");
+    table.Write("table");
+    file->Close();
+
+    LOG(info) << "R3BGTPCDriftMap: written to " << fileName;
+    return kTRUE;
+}
+
+Bool_t R3BGTPCDriftMap::Read(const TString& fileName, const TString& key)
+{
+    std::unique_ptr<TFile> file(TFile::Open(fileName, "READ"));
+    if (!file || file->IsZombie())
+        return kFALSE;
+
+    auto fileKey = dynamic_cast<TObjString*>(file->Get("key"));
+    auto grid = dynamic_cast<TVectorD*>(file->Get("grid"));
+    auto table = dynamic_cast<TVectorF*>(file->Get("table"));
+    if (!fileKey || !grid || !table || grid->GetNrows() != 7)
+    {
+        LOG(warn) << "R3BGTPCDriftMap::Read: " << fileName << " is not a GTPC drift map";
+        return kFALSE;
+    }
+    if (fileKey->GetString() != key)
+    {
+        LOG(warn) << "R3BGTPCDriftMap::Read: " << fileName << " was built for different parameters";
+        return kFALSE;
+    }
+
+    Double_t min[3], max[3];
+    Double_t step = (*grid)[6];
+    for (Int_t c = 0; c < 3; c++)
+    {
+        min[c] = (*grid)[c];
+        max[c] = min[c] + ((Int_t)(*grid)[3 + c] - 1) * step;
+    }
+    SetGrid(min, max, step);
+    if ((size_t)table->GetNrows() != kNQuantities * (size_t)fN[0] * fN[1] * fN[2])
+    {
+        LOG(warn) << "R3BGTPCDriftMap::Read: " << fileName << " has an inconsistent size";
+        return kFALSE;
+    }
+    fTable.assign(table->GetMatrixArray(), table->GetMatrixArray() + table->GetNrows());
+    fKey = key;
+
+    LOG(info) << "R3BGTPCDriftMap: read from " << fileName;
+    return kTRUE;
+}
+
+Bool_t R3BGTPCDriftMap::IsInside(Double_t x, Double_t y, Double_t z) const
+{
+    return x >= fMin[0] && x <= fMax[0] && y >= fMin[1] && y <= fMax[1] && z >= fMin[2] && z <= fMax[2];
+}
+
+void R3BGTPCDriftMap::GetTransfer(Double_t x, Double_t y, Double_t z, Double_t* out) const
+{
+    Double_t u = (x - fMin[0]) * fInvStep;
+    Double_t v = (y - fMin[1]) * fInvStep;
+    Double_t w = (z - fMin[2]) * fInvStep;
+    Int_t i = std::max(0, std::min((Int_t)u, fN[0] - 2));
+    Int_t j = std::max(0, std::min((Int_t)v, fN[1] - 2));
+    Int_t k = std::max(0, std::min((Int_t)w, fN[2] - 2));
+    Double_t fu = u - i;
+    Double_t fv = v - j;
+    Double_t fw = w - k;
+
+    const size_t sx = kNQuantities;
+    const size_t sy = sx * fN[0];
+    const size_t sz = sy * fN[1];
+    const Float_t* p = &fTable[k * sz + j * sy + i * sx];
+
+    for (Int_t c = 0; c < kNQuantities; c++)
+    {
+        Double_t t00 = p[c] + fu * (p[sx + c] - p[c]);
+        Double_t t10 = p[sy + c] + fu * (p[sy + sx + c] - p[sy + c]);
+        Double_t t01 = p[sz + c] + fu * (p[sz + sx + c] - p[sz + c]);
+        Double_t t11 = p[sz + sy + c] + fu * (p[sz + sy + sx + c] - p[sz + sy + c]);
+        Double_t t0 = t00 + fv * (t10 - t00);
+        Double_t t1 = t01 + fv * (t11 - t01);
+        out[c] = t0 + fw * (t1 - t0);
+    }
+}
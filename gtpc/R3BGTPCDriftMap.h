@@ -0,0 +1,98 @@
+/******************************************************************************
+ *   Copyright (C) 2018 GSI Helmholtzzentrum für Schwerionenforschung GmbH    *
+ *   Copyright (C) 2018-2025 Members of R3B Collaboration                     *
+ *                                                                            *
+ *             This software is distributed under the terms of the            *
+ *                 GNU Lesser General Public Licence (LGPL) version 3,        *
+ *                    copied verbatim in the file "LICENSE".                  *
+ *                                                                            *
+ * In applying this license GSI does not waive the privileges and immunities  *
+ * granted to it by virtue of its status as an Intergovernmental Organization *
+ * or submit itself to any jurisdiction.                                      *
+ ******************************************************************************/
+
+/**  R3BGTPCDriftMap.h
+ * Drift transfer table: for a grid of starting positions in the active
+ * volume, the mean arrival position on the pad plane, the drift time and
+ * the accumulated diffusion, obtained once with the Langevin drift stepper
+ **/
+
+#pragma once
+
+#include "R3BGTPCDriftStepper.h"
+#include "Rtypes.h"
+#include "TString.h"
+
+#include <vector>
+
+/**
+ * GTPC drift transfer map
+ *
+ * Each node holds (kX, kZ, kTime, kSigmaTransv, kSigmaTime): mean x and z at
+ * the pad plane [cm], mean drift time [ns], transversal sigma at the pad
+ * plane [cm] (already reduced by the magnetic field) and the longitudinal
+ * spread expressed as a time sigma [ns]. Values between nodes are obtained
+ * by trilinear interpolation.
+ *
+ * The table depends only on the drift parameters, the integrator settings of
+ * the stepper, the region and the field, so it is written to a file named
+ * after those values (see MakeKey) and read back by later runs with the same
+ * settings.
+ */
+
+class R3BGTPCDriftMap
+{
+  public:
+    enum Quantity
+    {
+        kX = 0,
+        kZ,
+        kTime,
+        kSigmaTransv,
+        kSigmaTime,
+        kNQuantities
+    };
+
+    /** Default constructor **/
+    R3BGTPCDriftMap();
+
+    /** Destructor **/
+    ~R3BGTPCDriftMap() = default;
+
+    /** Fill the table drifting with the stepper the mean electron from every
+     ** node of the box [min,max] with the given grid spacing [cm] **/
+    void Build(const R3BGTPCDriftStepper& stepper, const Double_t* min, const Double_t* max, Double_t step);
+
+    /** Persistency, the key must match for a file to be accepted **/
+    Bool_t Write(const TString& fileName) const;
+    Bool_t Read(const TString& fileName, const TString& key);
+
+    /** Unique description of the settings the table depends on **/
+    static TString MakeKey(const R3BGTPCDriftStepper& stepper,
+                           const Double_t* min,
+                           const Double_t* max,
+                           Double_t step);
+
+    /** File name derived from the key, in directory dir **/
+    static TString MakeFileName(const TString& dir, const TString& key);
+
+    /** True if (x,y,z) [cm] is covered by the table **/
+    Bool_t IsInside(Double_t x, Double_t y, Double_t z) const;
+
+    /** Interpolated transfer values for a start point (x,y,z) [cm] in out[kNQuantities] **/
+    void GetTransfer(Double_t x, Double_t y, Double_t z, Double_t* out) const;
+
+    const TString& GetKey() const { return fKey; }
+    Bool_t IsReady() const { return !fTable.empty(); }
+
+  private:
+    TString fKey;                //!< Settings the table was built for
+    Double_t fMin[3];            //!< Lower corner of the grid [cm]
+    Double_t fMax[3];            //!< Upper corner of the grid [cm]
+    Double_t fStep;              //!< Grid spacing [cm]
+    Double_t fInvStep;           //!< 1/fStep [cm^-1]
+    Int_t fN[3];                 //!< Number of nodes in x, y, z
+    std::vector<Float_t> fTable; //!< kNQuantities values per node, x running fastest
+
+    void SetGrid(const Double_t* min, const Double_t* max, Double_t step);
+};
@@ -0,0 +1,38 @@
+/******************************************************************************
+ *   Copyright (C) 2018 GSI Helmholtzzentrum für Schwerionenforschung GmbH    *
+ *   Copyright (C) 2018-2025 Members of R3B Collaboration                     *
+ *                                                                            *
+ *             This software is distributed under the terms of the            *
+ *                 GNU Lesser General Public Licence (LGPL) version 3,        *
+ *                    copied verbatim in the file "LICENSE".                  *
+ *                                                                            *
+ * In applying this license GSI does not waive the privileges and immunities  *
+ * granted to it by virtue of its status as an Intergovernmental Organization *
+ * or submit itself to any jurisdiction.                                      *
+ ******************************************************************************/
+
+/**  R3BGTPCDriftParameters.h
+ * Plain copy of the gas, electronics and geometry values needed to drift
+ * electrons, filled from the parameter containers by the drift tasks
+ **/
+
+#pragma once
+
+#include "Rtypes.h"
+
+struct R3BGTPCDriftParameters
+{
+    Double_t fDriftVelocity = 0.; //!< Drift velocity in gas [cm/ns]
+    Double_t fTransDiff = 0.;     //!< Transversal diffusion coefficient [cm^2/ns]
+    Double_t fLongDiff = 0.;      //!< Longitudinal diffusion coefficient [cm^2/ns]
+    Double_t fDriftEField = 0.;   //!< Drift electric field [V/cm]
+    Double_t fDriftTimeStep = 0.; //!< Time Step between drift parameters calculation [ns]
+    Double_t fHalfSizeTPC_X = 0.; //!< Half size X of the TPC drift volume [cm]
+    Double_t fHalfSizeTPC_Y = 0.; //!< Half size Y of the TPC drift volume [cm]
+    Double_t fHalfSizeTPC_Z = 0.; //!< Half size Z of the TPC drift volume [cm]
+    Double_t fOffsetX = 0.;       //!< X offset of the pad plane [cm]
+    Double_t fOffsetZ = 0.;       //!< Z offset of the pad plane [cm]
+
+    /** Electron mobility [cm^2 ns^-1 V^-1] **/
+    Double_t GetMobility() const { return fDriftVelocity / fDriftEField; }
+};
@@ -0,0 +1,957 @@
+/******************************************************************************
+ *   Copyright (C) 2018 GSI Helmholtzzentrum für Schwerionenforschung GmbH    *
+ *   Copyright (C) 2018-2025 Members of R3B Collaboration                     *
+ *                                                                            *
+ *             This software is distributed under the terms of the            *
+ *                 GNU Lesser General Public Licence (LGPL) version 3,        *
+ *                    copied verbatim in the file "LICENSE".                  *
+ *                                                                            *
+ * In applying this license GSI does not waive the privileges and immunities  *
+ * granted to it by virtue of its status as an Intergovernmental Organization *
+ * or submit itself to any jurisdiction.                                      *
+ ******************************************************************************/
+
+#include "R3BGTPCDriftStepper.h"
+#include "R3BGTPCRandom.h"
+
+#include "FairLogger.h"
+#include "TMath.h"
+
+#include <algorithm>
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace
+{
+    // Butcher tableaus of the Runge-Kutta integrators (autonomous ODE, the c
+    // nodes are not needed). e are the weights of the embedded error estimate
+    struct Tableau
+    {
+        Int_t stages;
+        Double_t a[6][5];
+        Double_t b[6];
+        Double_t e[6];
+    };
+
+    constexpr Tableau kClassicRK4 = { 4,
+                                      { {}, { 1. / 2 }, { 0., 1. / 2 }, { 0., 0., 1. } },
+                                      { 1. / 6, 1. / 3, 1. / 3, 1. / 6 },
+                                      {} };
+
+    constexpr Tableau kCashKarp = {
+        6,
+        { {},
+          { 1. / 5 },
+          { 3. / 40, 9. / 40 },
+          { 3. / 10, -9. / 10, 6. / 5 },
+          { -11. / 54, 5. / 2, -70. / 27, 35. / 27 },
+          { 1631. / 55296, 175. / 512, 575. / 13824, 44275. / 110592, 253. / 4096 } },
+        { 37. / 378, 0., 250. / 621, 125. / 594, 0., 512. / 1771 },
+        { 37. / 378 - 2825. / 27648,
+          0.,
+          250. / 621 - 18575. / 48384,
+          125. / 594 - 13525. / 55296,
+          -277. / 14336,
+          512. / 1771 - 1. / 4 }
+    };
+} // namespace
+
+void R3BGTPCDriftStepper::Electrons::Clear()
+{
+    x.clear();
+    y.clear();
+    z.clear();
+    t.clear();
+    varLong.clear();
+    varTransv.clear();
+    id.clear();
+}
+
+void R3BGTPCDriftStepper::Electrons::Add(Double_t ex, Double_t ey, Double_t ez, Double_t et, Int_t eid)
+{
+    id.push_back(eid < 0 ? x.size() : eid);
+    x.push_back(ex);
+    y.push_back(ey);
+    z.push_back(ez);
+    t.push_back(et);
+}
+
+R3BGTPCDriftStepper::R3BGTPCDriftStepper(const R3BGTPCFieldCache* field, const R3BGTPCDriftParameters& par)
+    : fField(field)
+    , fPar(par)
+    , fMu(par.GetMobility())
+    , fIntegrator(kEuler)
+    , fTolerance(1e-4)
+    , fParallelTolerance(0.)
+    , fNClosedForm(0)
+    , fNStepped(0)
+{
+}
+
+void R3BGTPCDriftStepper::SetIntegrator(EIntegrator integrator, Double_t tolerance)
+{
+    fIntegrator = integrator;
+    fTolerance = tolerance;
+}
+
+const char* R3BGTPCDriftStepper::GetIntegratorName(EIntegrator integrator)
+{
+    switch (integrator)
+    {
+        case kRK4:
+            return "RK4";
+        case kRK45:
+            return "RK45";
+        default:
+            return "Euler";
+    }
+}
+
+void R3BGTPCDriftStepper::SetParallelTolerance(Double_t tolerance)
+{
+    fParallelTolerance = tolerance;
+    fNonParallel.clear();
+    if (tolerance <= 0. || !fField)
+        return;
+
+    // Per grid column, number of non parallel nodes up to each node in y
+    const Int_t nx = fField->GetNx();
+    const Int_t ny = fField->GetNy();
+    const Int_t nz = fField->GetNz();
+    fNonParallel.resize((size_t)nx * ny * nz);
+    Double_t B[3];
+    size_t parallel = 0;
+    for (Int_t k = 0; k < nz; k++)
+    {
+        for (Int_t i = 0; i < nx; i++)
+        {
+            Int_t* column = &fNonParallel[((size_t)k * nx + i) * ny];
+            Int_t count = 0;
+            for (Int_t j = 0; j < ny; j++)
+            {
+                fField->GetNodeField(i, j, k, B);
+                if (B[0] * B[0] + B[2] * B[2] > tolerance * tolerance * B[1] * B[1])
+                    count++;
+                column[j] = count;
+            }
+            parallel += ny - count;
+        }
+    }
+    LOG(info) << "R3BGTPCDriftStepper: " << parallel << " of " << fNonParallel.size()
+              << " field nodes with E||B within " << tolerance;
+}
+
+void R3BGTPCDriftStepper::LogStatistics(const char* owner) const
+{
+    Long64_t total = fNClosedForm + fNStepped;
+    LOG(info) << owner << ": " << fNClosedForm << " of " << total << " electron drifts in closed form (E||B), "
+              << fNStepped << " with the " << GetIntegratorName(fIntegrator) << " integrator";
+}
+
+Bool_t R3BGTPCDriftStepper::IsParallel(Double_t x, Double_t z, Double_t yLow, Double_t yHigh) const
+{
+    if (fNonParallel.empty() || !fField->IsInside(x, yLow, z) || !fField->IsInside(x, yHigh, z))
+        return kFALSE;
+
+    const Int_t nx = fField->GetNx();
+    const Int_t ny = fField->GetNy();
+    const Int_t nz = fField->GetNz();
+    const Double_t* min = fField->GetMin();
+    const Double_t invStep = 1. / fField->GetStep();
+    Int_t i = std::min((Int_t)((x - min[0]) * invStep), nx - 2);
+    Int_t k = std::min((Int_t)((z - min[2]) * invStep), nz - 2);
+    Int_t jLow = (Int_t)((yLow - min[1]) * invStep);
+    Int_t jHigh = std::min((Int_t)((yHigh - min[1]) * invStep) + 1, ny - 1);
+
+    // the four columns of nodes used in the interpolation around the path
+    for (Int_t dk = 0; dk < 2; dk++)
+    {
+        for (Int_t di = 0; di < 2; di++)
+        {
+            const Int_t* column = &fNonParallel[((size_t)(k + dk) * nx + i + di) * ny];
+            if (column[jHigh] - (jLow > 0 ? column[jLow - 1] : 0) > 0)
+                return kFALSE;
+        }
+    }
+    return kTRUE;
+}
+
+Double_t R3BGTPCDriftStepper::MeanCteMod(Double_t x, Double_t z, Double_t yLow, Double_t yHigh) const
+{
+    // Simpson rule over the path, B in [kG] moved to [V ns cm^-2]
+    const Double_t mu2 = fMu * fMu * 1e8;
+    Double_t B[3];
+    Double_t mod[3];
+    for (Int_t p = 0; p < 3; p++)
+    {
+        fField->GetField(x, yLow + 0.5 * p * (yHigh - yLow), z, B);
+        mod[p] = 1 / (1 + mu2 * (B[0] * B[0] + B[1] * B[1] + B[2] * B[2]));
+    }
+    return (mod[0] + 4 * mod[1] + mod[2]) / 6;
+}
+
+void R3BGTPCDriftStepper::DriftForward(Electrons& ele, R3BGTPCRandom& rnd) const
+{
+    Forward(ele, &rnd);
+}
+
+void R3BGTPCDriftStepper::DriftForwardMean(Electrons& ele) const
+{
+    Forward(ele, nullptr);
+}
+
+void R3BGTPCDriftStepper::Forward(Electrons& ele, R3BGTPCRandom* rnd) const
+{
+    const Int_t n = ele.GetSize();
+    ele.varLong.assign(n, 0.);
+    ele.varTransv.assign(n, 0.);
+    if (fNonParallel.empty())
+    {
+        StepForward(ele, rnd);
+        fNStepped += n;
+        return;
+    }
+
+    // Electrons with E||B along the whole path go to the pad plane in one
+    // step: no transversal drift, v=v_drift along y and reduced diffusion
+    const Double_t padPlane = -fPar.fHalfSizeTPC_Y;
+    const Double_t v = fPar.fDriftVelocity;
+    const Double_t twoDT = 2 * fPar.fTransDiff;
+    const Double_t twoDL = 2 * fPar.fLongDiff;
+    Electrons rest;
+    std::vector<Int_t> index;
+    for (Int_t e = 0; e < n; e++)
+    {
+        if (ele.y[e] > padPlane && IsParallel(ele.x[e], ele.z[e], padPlane, ele.y[e]))
+        {
+            Double_t time = (ele.y[e] - padPlane) / v;
+            ele.varTransv[e] = time * twoDT * MeanCteMod(ele.x[e], ele.z[e], padPlane, ele.y[e]);
+            ele.varLong[e] = time * twoDL;
+            Double_t gaus[4] = { 0., 0., 0., 0. };
+            if (rnd)
+                rnd->ElectronGaus(ele.id[e], 0, gaus);
+            ele.x[e] += sqrt(ele.varTransv[e]) * gaus[0];
+            ele.t[e] += time + sqrt(ele.varLong[e]) / v * gaus[1];
+            ele.z[e] += sqrt(ele.varTransv[e]) * gaus[2];
+            ele.y[e] = padPlane;
+        }
+        else
+        {
+            rest.Add(ele.x[e], ele.y[e], ele.z[e], ele.t[e], ele.id[e]);
+            index.push_back(e);
+        }
+    }
+    fNClosedForm += n - rest.GetSize();
+    fNStepped += rest.GetSize();
+
+    StepForward(rest, rnd);
+    for (Int_t r = 0; r < rest.GetSize(); r++)
+    {
+        ele.x[index[r]] = rest.x[r];
+        ele.y[index[r]] = rest.y[r];
+        ele.z[index[r]] = rest.z[r];
+        ele.t[index[r]] = rest.t[r];
+        ele.varLong[index[r]] = rest.varLong[r];
+        ele.varTransv[index[r]] = rest.varTransv[r];
+    }
+}
+
+void R3BGTPCDriftStepper::DriftBackward(Electrons& ele) const
+{
+    const Int_t n = ele.GetSize();
+    if (fNonParallel.empty())
+    {
+        StepBackward(ele);
+        fNStepped += n;
+        return;
+    }
+
+    // Electrons with E||B along the whole path in one step, as in DriftForward
+    const Double_t v = fPar.fDriftVelocity;
+    const Double_t twoDT = 2 * fPar.fTransDiff;
+    const Double_t twoDL = 2 * fPar.fLongDiff;
+    ele.varLong.assign(n, 0.);
+    ele.varTransv.assign(n, 0.);
+    Electrons rest;
+    std::vector<Int_t> index;
+    for (Int_t e = 0; e < n; e++)
+    {
+        Double_t yEnd = ele.y[e] + v * ele.t[e];
+        if (ele.t[e] > 0. && IsParallel(ele.x[e], ele.z[e], ele.y[e], yEnd))
+        {
+            ele.varLong[e] = ele.t[e] * twoDL;
+            ele.varTransv[e] = ele.t[e] * twoDT * MeanCteMod(ele.x[e], ele.z[e], ele.y[e], yEnd);
+            ele.y[e] = yEnd;
+            ele.t[e] = 0.;
+        }
+        else
+        {
+            rest.Add(ele.x[e], ele.y[e], ele.z[e], ele.t[e]);
+            index.push_back(e);
+        }
+    }
+    fNClosedForm += n - rest.GetSize();
+    fNStepped += rest.GetSize();
+
+    StepBackward(rest);
+    for (Int_t r = 0; r < rest.GetSize(); r++)
+    {
+        ele.x[index[r]] = rest.x[r];
+        ele.y[index[r]] = rest.y[r];
+        ele.z[index[r]] = rest.z[r];
+        ele.t[index[r]] = rest.t[r];
+        ele.varLong[index[r]] = rest.varLong[r];
+        ele.varTransv[index[r]] = rest.varTransv[r];
+    }
+}
+
+const char* R3BGTPCDriftStepper::GetInstructionSet()
+{
+#if defined(__AVX512F__)
+    return "AVX-512";
+#elif defined(__AVX2__)
+    return "AVX2";
+#else
+    return "scalar";
+#endif
+}
+
+void R3BGTPCDriftStepper::GetField(const Double_t* x,
+                                   const Double_t* y,
+                                   const Double_t* z,
+                                   const Bool_t* mask,
+                                   Double_t* bx,
+                                   Double_t* by,
+                                   Double_t* bz) const
+{
+    Double_t B[3];
+    for (Int_t l = 0; l < kLanes; l++)
+    {
+        if (!mask[l])
+        {
+            bx[l] = by[l] = bz[l] = 0.;
+            continue;
+        }
+        fField->GetField(x[l], y[l], z[l], B);
+        bx[l] = 1e4 * B[0]; // Field components return in [kG],
+        by[l] = 1e4 * B[1]; // moved to [V ns cm^-2]
+        bz[l] = 1e4 * B[2];
+    }
+}
+
+// Langevin solution for E along y (see R3BGTPCLangevin):
+//   cteMod = 1/(1+mu^2 B^2), cteMult = mu*cteMod, productEB = E_y*B_y
+//   v_x = cteMult*( mu*E_y*B_z + mu^2*productEB*B_x)
+//   v_y = cteMult*(     E_y    + mu^2*productEB*B_y)
+//   v_z = cteMult*(-mu*E_y*B_x + mu^2*productEB*B_z)
+void R3BGTPCDriftStepper::Velocity(const Double_t* bx,
+                                   const Double_t* by,
+                                   const Double_t* bz,
+                                   Double_t* vx,
+                                   Double_t* vy,
+                                   Double_t* vz,
+                                   Double_t* cteMod) const
+{
+    const Double_t E_y = fPar.fDriftEField;
+    const Double_t mu = fMu;
+    const Double_t mu2 = fMu * fMu;
+#if defined(__AVX512F__)
+    const __m512d vMu = _mm512_set1_pd(mu);
+    const __m512d vMu2 = _mm512_set1_pd(mu2);
+    const __m512d vEy = _mm512_set1_pd(E_y);
+    const __m512d vMuEy = _mm512_set1_pd(mu * E_y);
+    const __m512d vOne = _mm512_set1_pd(1.);
+    for (Int_t l = 0; l < kLanes; l += 8)
+    {
+        __m512d Bx = _mm512_loadu_pd(bx + l);
+        __m512d By = _mm512_loadu_pd(by + l);
+        __m512d Bz = _mm512_loadu_pd(bz + l);
+        __m512d B2 = _mm512_add_pd(_mm512_add_pd(_mm512_mul_pd(Bx, Bx), _mm512_mul_pd(By, By)), _mm512_mul_pd(Bz, Bz));
+        __m512d mod = _mm512_div_pd(vOne, _mm512_add_pd(vOne, _mm512_mul_pd(vMu2, B2)));
+        __m512d mult = _mm512_mul_pd(vMu, mod);
+        __m512d k = _mm512_mul_pd(vMu2, _mm512_mul_pd(vEy, By)); // mu^2*productEB
+        _mm512_storeu_pd(vx + l, _mm512_mul_pd(mult, _mm512_add_pd(_mm512_mul_pd(vMuEy, Bz), _mm512_mul_pd(k, Bx))));
+        _mm512_storeu_pd(vy + l, _mm512_mul_pd(mult, _mm512_add_pd(vEy, _mm512_mul_pd(k, By))));
+        _mm512_storeu_pd(vz + l, _mm512_mul_pd(mult, _mm512_sub_pd(_mm512_mul_pd(k, Bz), _mm512_mul_pd(vMuEy, Bx))));
+        _mm512_storeu_pd(cteMod + l, mod);
+    }
+#elif defined(__AVX2__)
+    const __m256d vMu = _mm256_set1_pd(mu);
+    const __m256d vMu2 = _mm256_set1_pd(mu2);
+    const __m256d vEy = _mm256_set1_pd(E_y);
+    const __m256d vMuEy = _mm256_set1_pd(mu * E_y);
+    const __m256d vOne = _mm256_set1_pd(1.);
+    for (Int_t l = 0; l < kLanes; l += 4)
+    {
+        __m256d Bx = _mm256_loadu_pd(bx + l);
+        __m256d By = _mm256_loadu_pd(by + l);
+        __m256d Bz = _mm256_loadu_pd(bz + l);
+        __m256d B2 = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(Bx, Bx), _mm256_mul_pd(By, By)), _mm256_mul_pd(Bz, Bz));
+        __m256d mod = _mm256_div_pd(vOne, _mm256_add_pd(vOne, _mm256_mul_pd(vMu2, B2)));
+        __m256d mult = _mm256_mul_pd(vMu, mod);
+        __m256d k = _mm256_mul_pd(vMu2, _mm256_mul_pd(vEy, By)); // mu^2*productEB
+        _mm256_storeu_pd(vx + l, _mm256_mul_pd(mult, _mm256_add_pd(_mm256_mul_pd(vMuEy, Bz), _mm256_mul_pd(k, Bx))));
+        _mm256_storeu_pd(vy + l, _mm256_mul_pd(mult, _mm256_add_pd(vEy, _mm256_mul_pd(k, By))));
+        _mm256_storeu_pd(vz + l, _mm256_mul_pd(mult, _mm256_sub_pd(_mm256_mul_pd(k, Bz), _mm256_mul_pd(vMuEy, Bx))));
+        _mm256_storeu_pd(cteMod + l, mod);
+    }
+#else
+    for (Int_t l = 0; l < kLanes; l++)
+    {
+        Double_t mod = 1 / (1 + mu2 * (bx[l] * bx[l] + by[l] * by[l] + bz[l] * bz[l]));
+        Double_t mult = mu * mod;
+        Double_t k = mu2 * E_y * by[l];
+        vx[l] = mult * (mu * E_y * bz[l] + k * bx[l]);
+        vy[l] = mult * (E_y + k * by[l]);
+        vz[l] = mult * (k * bz[l] - mu * E_y * bx[l]);
+        cteMod[l] = mod;
+    }
+#endif
+}
+
+void R3BGTPCDriftStepper::ForwardStep(const Double_t* y,
+                                      const Double_t* vy,
+                                      const Double_t* cteMod,
+                                      Double_t* dt,
+                                      Double_t* sigmaTransv,
+                                      Double_t* sigmaLong) const
+{
+    const Double_t padPlane = -fPar.fHalfSizeTPC_Y;
+    const Double_t step = fPar.fDriftTimeStep;
+    const Double_t twoDT = 2 * fPar.fTransDiff;
+    const Double_t twoDL = 2 * fPar.fLongDiff;
+#if defined(__AVX512F__)
+    const __m512d vPad = _mm512_set1_pd(padPlane);
+    const __m512d vStep = _mm512_set1_pd(step);
+    const __m512d vTwoDT = _mm512_set1_pd(twoDT);
+    const __m512d vTwoDL = _mm512_set1_pd(twoDL);
+    for (Int_t l = 0; l < kLanes; l += 8)
+    {
+        __m512d Y = _mm512_loadu_pd(y + l);
+        __m512d Vy = _mm512_loadu_pd(vy + l);
+        __mmask8 active = _mm512_cmp_pd_mask(Y, vPad, _CMP_GT_OQ);
+        // adjusting the last step before the pad plane
+        __mmask8 last = _mm512_cmp_pd_mask(_mm512_sub_pd(Y, _mm512_mul_pd(Vy, vStep)), vPad, _CMP_LT_OQ);
+        __m512d T = _mm512_mask_div_pd(vStep, last, _mm512_sub_pd(Y, vPad), Vy);
+        T = _mm512_maskz_mov_pd(active, T);
+        _mm512_storeu_pd(dt + l, T);
+        _mm512_storeu_pd(sigmaTransv + l,
+                         _mm512_sqrt_pd(_mm512_mul_pd(_mm512_mul_pd(T, vTwoDT), _mm512_loadu_pd(cteMod + l))));
+        _mm512_storeu_pd(sigmaLong + l, _mm512_sqrt_pd(_mm512_mul_pd(T, vTwoDL)));
+    }
+#elif defined(__AVX2__)
+    const __m256d vPad = _mm256_set1_pd(padPlane);
+    const __m256d vStep = _mm256_set1_pd(step);
+    const __m256d vTwoDT = _mm256_set1_pd(twoDT);
+    const __m256d vTwoDL = _mm256_set1_pd(twoDL);
+    for (Int_t l = 0; l < kLanes; l += 4)
+    {
+        __m256d Y = _mm256_loadu_pd(y + l);
+        __m256d Vy = _mm256_loadu_pd(vy + l);
+        __m256d active = _mm256_cmp_pd(Y, vPad, _CMP_GT_OQ);
+        // adjusting the last step before the pad plane
+        __m256d last = _mm256_cmp_pd(_mm256_sub_pd(Y, _mm256_mul_pd(Vy, vStep)), vPad, _CMP_LT_OQ);
+        __m256d T = _mm256_blendv_pd(vStep, _mm256_div_pd(_mm256_sub_pd(Y, vPad), Vy), last);
+        T = _mm256_and_pd(T, active);
+        _mm256_storeu_pd(dt + l, T);
+        _mm256_storeu_pd(sigmaTransv + l,
+                         _mm256_sqrt_pd(_mm256_mul_pd(_mm256_mul_pd(T, vTwoDT), _mm256_loadu_pd(cteMod + l))));
+        _mm256_storeu_pd(sigmaLong + l, _mm256_sqrt_pd(_mm256_mul_pd(T, vTwoDL)));
+    }
+#else
+    for (Int_t l = 0; l < kLanes; l++)
+    {
+        Double_t T = step;
+        // adjusting the last step before the pad plane
+        if (y[l] - vy[l] * T < padPlane)
+            T = (y[l] - padPlane) / vy[l];
+        if (!(y[l] > padPlane))
+            T = 0.;
+        dt[l] = T;
+        // reducing sigmaTransv as B~B_y and E=E_y (see R3BGTPCLangevin)
+        sigmaTransv[l] = sqrt(T * twoDT * cteMod[l]);
+        sigmaLong[l] = sqrt(T * twoDL);
+    }
+#endif
+}
+
+void R3BGTPCDriftStepper::Derivative(const Double_t* x,
+                                     const Double_t* y,
+                                     const Double_t* z,
+                                     const Bool_t* mask,
+                                     Double_t sign,
+                                     Double_t* kx,
+                                     Double_t* ky,
+                                     Double_t* kz,
+                                     Double_t* cteMod) const
+{
+    alignas(64) Double_t bx[kLanes], by[kLanes], bz[kLanes];
+    alignas(64) Double_t vx[kLanes], vy[kLanes], vz[kLanes];
+    GetField(x, y, z, mask, bx, by, bz);
+    Velocity(bx, by, bz, vx, vy, vz, cteMod);
+    // the electrons move towards -y (see DriftForward)
+    for (Int_t l = 0; l < kLanes; l++)
+    {
+        kx[l] = sign * vx[l];
+        ky[l] = -sign * vy[l];
+        kz[l] = sign * vz[l];
+    }
+}
+
+void R3BGTPCDriftStepper::RungeKuttaStep(const Double_t* x,
+                                         const Double_t* y,
+                                         const Double_t* z,
+                                         const Double_t* dt,
+                                         const Bool_t* mask,
+                                         Double_t sign,
+                                         Double_t* nx,
+                                         Double_t* ny,
+                                         Double_t* nz,
+                                         Double_t* err,
+                                         Double_t* cteMod) const
+{
+    const Tableau& tab = fIntegrator == kRK45 ? kCashKarp : kClassicRK4;
+    alignas(64) Double_t kx[6][kLanes], ky[6][kLanes], kz[6][kLanes], mod[6][kLanes];
+    alignas(64) Double_t px[kLanes], py[kLanes], pz[kLanes];
+
+    for (Int_t s = 0; s < tab.stages; s++)
+    {
+        for (Int_t l = 0; l < kLanes; l++)
+        {
+            Double_t sx = 0., sy = 0., sz = 0.;
+            for (Int_t j = 0; j < s; j++)
+            {
+                sx += tab.a[s][j] * kx[j][l];
+                sy += tab.a[s][j] * ky[j][l];
+                sz += tab.a[s][j] * kz[j][l];
+            }
+            px[l] = x[l] + dt[l] * sx;
+            py[l] = y[l] + dt[l] * sy;
+            pz[l] = z[l] + dt[l] * sz;
+        }
+        Derivative(px, py, pz, mask, sign, kx[s], ky[s], kz[s], mod[s]);
+    }
+
+    // Only the lanes in mask: the others keep the step they already accepted
+    for (Int_t l = 0; l < kLanes; l++)
+    {
+        if (!mask[l])
+            continue;
+        Double_t sx = 0., sy = 0., sz = 0., sm = 0.;
+        Double_t ex = 0., ey = 0., ez = 0.;
+        for (Int_t s = 0; s < tab.stages; s++)
+        {
+            sx += tab.b[s] * kx[s][l];
+            sy += tab.b[s] * ky[s][l];
+            sz += tab.b[s] * kz[s][l];
+            sm += tab.b[s] * mod[s][l];
+            ex += tab.e[s] * kx[s][l];
+            ey += tab.e[s] * ky[s][l];
+            ez += tab.e[s] * kz[s][l];
+        }
+        nx[l] = x[l] + dt[l] * sx;
+        ny[l] = y[l] + dt[l] * sy;
+        nz[l] = z[l] + dt[l] * sz;
+        err[l] = dt[l] * sqrt(ex * ex + ey * ey + ez * ez);
+        cteMod[l] = sm;
+    }
+}
+
+Double_t R3BGTPCDriftStepper::NextStep(Double_t dt, Double_t err, Bool_t accepted) const
+{
+    // usual step control for a 4th order error estimate, with a safety factor
+    // and limited growth/shrinking
+    Double_t factor = 5.;
+    if (err > 0.)
+        factor = 0.9 * pow(fTolerance / err, accepted ? 0.2 : 0.25);
+    factor = std::max(0.2, std::min(5., factor));
+    return std::min(fPar.fDriftTimeStep, dt * factor);
+}
+
+void R3BGTPCDriftStepper::StepForward(Electrons& ele, R3BGTPCRandom* rnd) const
+{
+    if (fIntegrator != kEuler)
+    {
+        StepForwardRungeKutta(ele, rnd);
+        return;
+    }
+
+    const Double_t padPlane = -fPar.fHalfSizeTPC_Y;
+    const Int_t n = ele.GetSize();
+    ele.varLong.assign(n, 0.);
+    ele.varTransv.assign(n, 0.);
+
+    alignas(64) Double_t x[kLanes], y[kLanes], z[kLanes], t[kLanes];
+    alignas(64) Double_t bx[kLanes], by[kLanes], bz[kLanes];
+    alignas(64) Double_t vx[kLanes], vy[kLanes], vz[kLanes], cteMod[kLanes];
+    alignas(64) Double_t dt[kLanes], sigmaTransv[kLanes], sigmaLong[kLanes], varLong[kLanes], varTransv[kLanes];
+    UInt_t id[kLanes], steps[kLanes];
+    Bool_t mask[kLanes];
+
+    for (Int_t first = 0; first < n; first += kLanes)
+    {
+        const Int_t lanes = std::min(kLanes, n - first);
+        Int_t active = 0;
+        for (Int_t l = 0; l < kLanes; l++)
+        {
+            if (l < lanes)
+            {
+                x[l] = ele.x[first + l];
+                y[l] = ele.y[first + l];
+                z[l] = ele.z[first + l];
+                t[l] = ele.t[first + l];
+                id[l] = ele.id[first + l];
+            }
+            else
+            { // empty lane, already at the pad plane
+                x[l] = z[l] = t[l] = 0.;
+                y[l] = padPlane;
+                id[l] = 0;
+            }
+            steps[l] = 0;
+            varLong[l] = varTransv[l] = 0.;
+            mask[l] = y[l] > padPlane;
+            active += mask[l];
+        }
+
+        while (active > 0)
+        { // while not all the packet reached the pad plane [cm]
+            GetField(x, y, z, mask, bx, by, bz);
+            Velocity(bx, by, bz, vx, vy, vz, cteMod);
+            ForwardStep(y, vy, cteMod, dt, sigmaTransv, sigmaLong);
+
+            active = 0;
+            for (Int_t l = 0; l < kLanes; l++)
+            {
+                if (!mask[l])
+                    continue;
+                Double_t gaus[4] = { 0., 0., 0., 0. };
+                if (rnd)
+                    rnd->ElectronGaus(id[l], ++steps[l], gaus);
+                x[l] += vx[l] * dt[l] + sigmaTransv[l] * gaus[0]; // [cm]
+                y[l] -= vy[l] * dt[l] - sigmaLong[l] * gaus[1];   // [cm]
+                z[l] += vz[l] * dt[l] + sigmaTransv[l] * gaus[2]; // [cm]
+                t[l] += dt[l];                                    // [ns]
+                varTransv[l] += sigmaTransv[l] * sigmaTransv[l];
+                varLong[l] += sigmaLong[l] * sigmaLong[l];
+                mask[l] = y[l] > padPlane;
+                active += mask[l];
+            }
+        }
+
+        for (Int_t l = 0; l < lanes; l++)
+        {
+            ele.x[first + l] = x[l];
+            ele.y[first + l] = y[l];
+            ele.z[first + l] = z[l];
+            ele.t[first + l] = t[l];
+            ele.varLong[first + l] = varLong[l];
+            ele.varTransv[first + l] = varTransv[l];
+        }
+    }
+}
+
+void R3BGTPCDriftStepper::StepBackward(Electrons& ele) const
+{
+    if (fIntegrator != kEuler)
+    {
+        StepBackwardRungeKutta(ele);
+        return;
+    }
+
+    const Int_t n = ele.GetSize();
+    const Double_t step = fPar.fDriftTimeStep;
+    const Double_t twoDT = 2 * fPar.fTransDiff;
+    const Double_t twoDL = 2 * fPar.fLongDiff;
+    ele.varLong.assign(n, 0.);
+    ele.varTransv.assign(n, 0.);
+
+    alignas(64) Double_t x[kLanes], y[kLanes], z[kLanes], t[kLanes];
+    alignas(64) Double_t auxx[kLanes], auxy[kLanes], auxz[kLanes];
+    alignas(64) Double_t bx[kLanes], by[kLanes], bz[kLanes];
+    alignas(64) Double_t vx[kLanes], vy[kLanes], vz[kLanes], cteMod[kLanes];
+    alignas(64) Double_t dt[kLanes], varLong[kLanes], varTransv[kLanes];
+    Bool_t mask[kLanes];
+
+    for (Int_t first = 0; first < n; first += kLanes)
+    {
+        const Int_t lanes = std::min(kLanes, n - first);
+        Int_t active = 0;
+        for (Int_t l = 0; l < kLanes; l++)
+        {
+            if (l < lanes)
+            {
+                x[l] = ele.x[first + l];
+                y[l] = ele.y[first + l];
+                z[l] = ele.z[first + l];
+                t[l] = ele.t[first + l];
+            }
+            else
+            { // empty lane, nothing to drift
+                x[l] = y[l] = z[l] = t[l] = 0.;
+            }
+            varLong[l] = varTransv[l] = 0.;
+            mask[l] = t[l] > 0.;
+            active += mask[l];
+        }
+
+        while (active > 0)
+        { // till the remaining time is 0
+            for (Int_t l = 0; l < kLanes; l++)
+            {
+                // We adjust the time for the last step before reaching time=0
+                dt[l] = mask[l] ? std::min(step, t[l]) : 0.;
+            }
+
+            // Drift velocities for auxiliar point finding
+            GetField(x, y, z, mask, bx, by, bz);
+            Velocity(bx, by, bz, vx, vy, vz, cteMod);
+            for (Int_t l = 0; l < kLanes; l++)
+            {
+                auxx[l] = x[l] - vx[l] * dt[l];
+                auxy[l] = y[l] + vy[l] * dt[l];
+                auxz[l] = z[l] - vz[l] * dt[l];
+            }
+
+            // Velocity in the auxiliar point, used (reversed) to move backwards
+            GetField(auxx, auxy, auxz, mask, bx, by, bz);
+            Velocity(bx, by, bz, vx, vy, vz, cteMod);
+            active = 0;
+            for (Int_t l = 0; l < kLanes; l++)
+            {
+                x[l] -= vx[l] * dt[l];
+                y[l] += vy[l] * dt[l];
+                z[l] -= vz[l] * dt[l];
+                // Taking account of clouds widths
+                varLong[l] += dt[l] * twoDL;
+                varTransv[l] += dt[l] * twoDT * cteMod[l];
+                t[l] -= dt[l];
+                mask[l] = t[l] > 0.;
+                active += mask[l];
+            }
+        }
+
+        for (Int_t l = 0; l < lanes; l++)
+        {
+            ele.x[first + l] = x[l];
+            ele.y[first + l] = y[l];
+            ele.z[first + l] = z[l];
+            ele.t[first + l] = t[l];
+            ele.varLong[first + l] = varLong[l];
+            ele.varTransv[first + l] = varTransv[l];
+        }
+    }
+}
+
+void R3BGTPCDriftStepper::StepForwardRungeKutta(Electrons& ele, R3BGTPCRandom* rnd) const
+{
+    const Double_t padPlane = -fPar.fHalfSizeTPC_Y;
+    const Double_t maxStep = fPar.fDriftTimeStep;
+    const Double_t minStep = 1e-3 * maxStep;
+    const Double_t twoDT = 2 * fPar.fTransDiff;
+    const Double_t twoDL = 2 * fPar.fLongDiff;
+    const Bool_t adaptive = fIntegrator == kRK45;
+    const Int_t n = ele.GetSize();
+    ele.varLong.assign(n, 0.);
+    ele.varTransv.assign(n, 0.);
+
+    alignas(64) Double_t x[kLanes], y[kLanes], z[kLanes], t[kLanes];
+    alignas(64) Double_t nx[kLanes], ny[kLanes], nz[kLanes], err[kLanes], cteMod[kLanes];
+    alignas(64) Double_t dt[kLanes], step[kLanes], varLong[kLanes], varTransv[kLanes];
+    UInt_t id[kLanes], steps[kLanes];
+    Bool_t mask[kLanes], pending[kLanes], last[kLanes];
+
+    for (Int_t first = 0; first < n; first += kLanes)
+    {
+        const Int_t lanes = std::min(kLanes, n - first);
+        Int_t active = 0;
+        for (Int_t l = 0; l < kLanes; l++)
+        {
+            if (l < lanes)
+            {
+                x[l] = ele.x[first + l];
+                y[l] = ele.y[first + l];
+                z[l] = ele.z[first + l];
+                t[l] = ele.t[first + l];
+                id[l] = ele.id[first + l];
+            }
+            else
+            { // empty lane, already at the pad plane
+                x[l] = z[l] = t[l] = 0.;
+                y[l] = padPlane;
+                id[l] = 0;
+            }
+            steps[l] = 0;
+            step[l] = maxStep;
+            mask[l] = y[l] > padPlane;
+            active += mask[l];
+        }
+
+        while (active > 0)
+        { // while not all the packet reached the pad plane [cm]
+            Int_t nPending = 0;
+            for (Int_t l = 0; l < kLanes; l++)
+            {
+                dt[l] = mask[l] ? step[l] : 0.;
+                pending[l] = mask[l];
+                last[l] = kFALSE;
+                nPending += pending[l];
+            }
+
+            // The step of a lane is repeated while its error is too large and,
+            // once, shortened to end on the pad plane
+            while (nPending > 0)
+            {
+                RungeKuttaStep(x, y, z, dt, pending, 1., nx, ny, nz, err, cteMod);
+                nPending = 0;
+                for (Int_t l = 0; l < kLanes; l++)
+                {
+                    if (!pending[l])
+                        continue;
+                    if (adaptive && err[l] > fTolerance && dt[l] > minStep)
+                        dt[l] = std::max(minStep, NextStep(dt[l], err[l], kFALSE));
+                    else if (ny[l] < padPlane && !last[l])
+                    { // adjusting the last step before the pad plane
+                        dt[l] *= (y[l] - padPlane) / (y[l] - ny[l]);
+                        last[l] = kTRUE;
+                    }
+                    else
+                        pending[l] = kFALSE;
+                    nPending += pending[l];
+                }
+            }
+
+            active = 0;
+            for (Int_t l = 0; l < kLanes; l++)
+            {
+                if (!mask[l])
+                    continue;
+                // diffusion for the step taken, B~B_y and E=E_y (see R3BGTPCLangevin)
+                Double_t sigmaTransv = sqrt(dt[l] * twoDT * cteMod[l]);
+                Double_t sigmaLong = sqrt(dt[l] * twoDL);
+                Double_t gaus[4] = { 0., 0., 0., 0. };
+                if (rnd)
+                    rnd->ElectronGaus(id[l], ++steps[l], gaus);
+                x[l] = nx[l] + sigmaTransv * gaus[0]; // [cm]
+                y[l] = ny[l] + sigmaLong * gaus[1];   // [cm]
+                z[l] = nz[l] + sigmaTransv * gaus[2]; // [cm]
+                t[l] += dt[l];                        // [ns]
+                varTransv[l] += sigmaTransv * sigmaTransv;
+                varLong[l] += sigmaLong * sigmaLong;
+                if (adaptive && !last[l])
+                    step[l] = NextStep(dt[l], err[l], kTRUE);
+                mask[l] = y[l] > padPlane;
+                active += mask[l];
+            }
+        }
+
+        for (Int_t l = 0; l < lanes; l++)
+        {
+            ele.x[first + l] = x[l];
+            ele.y[first + l] = y[l];
+            ele.z[first + l] = z[l];
+            ele.t[first + l] = t[l];
+            ele.varLong[first + l] = varLong[l];
+            ele.varTransv[first + l] = varTransv[l];
+        }
+    }
+}
+
+void R3BGTPCDriftStepper::StepBackwardRungeKutta(Electrons& ele) const
+{
+    const Double_t maxStep = fPar.fDriftTimeStep;
+    const Double_t minStep = 1e-3 * maxStep;
+    const Double_t twoDT = 2 * fPar.fTransDiff;
+    const Double_t twoDL = 2 * fPar.fLongDiff;
+    const Bool_t adaptive = fIntegrator == kRK45;
+    const Int_t n = ele.GetSize();
+    ele.varLong.assign(n, 0.);
+    ele.varTransv.assign(n, 0.);
+
+    alignas(64) Double_t x[kLanes], y[kLanes], z[kLanes], t[kLanes];
+    alignas(64) Double_t nx[kLanes], ny[kLanes], nz[kLanes], err[kLanes], cteMod[kLanes];
+    alignas(64) Double_t dt[kLanes], step[kLanes], varLong[kLanes], varTransv[kLanes];
+    Bool_t mask[kLanes], pending[kLanes];
+
+    for (Int_t first = 0; first < n; first += kLanes)
+    {
+        const Int_t lanes = std::min(kLanes, n - first);
+        Int_t active = 0;
+        for (Int_t l = 0; l < kLanes; l++)
+        {
+            if (l < lanes)
+            {
+                x[l] = ele.x[first + l];
+                y[l] = ele.y[first + l];
+                z[l] = ele.z[first + l];
+                t[l] = ele.t[first + l];
+            }
+            else
+            { // empty lane, nothing to drift
+                x[l] = y[l] = z[l] = t[l] = 0.;
+            }
+            step[l] = maxStep;
+            varLong[l] = varTransv[l] = 0.;
+            mask[l] = t[l] > 0.;
+            active += mask[l];
+        }
+
+        while (active > 0)
+        { // till the remaining time is 0
+            Int_t nPending = 0;
+            for (Int_t l = 0; l < kLanes; l++)
+            {
+                // We adjust the time for the last step before reaching time=0
+                dt[l] = mask[l] ? std::min(step[l], t[l]) : 0.;
+                pending[l] = mask[l];
+                nPending += pending[l];
+            }
+
+            while (nPending > 0)
+            { // repeating the steps with a too large error
+                RungeKuttaStep(x, y, z, dt, pending, -1., nx, ny, nz, err, cteMod);
+                nPending = 0;
+                for (Int_t l = 0; l < kLanes; l++)
+                {
+                    if (!pending[l])
+                        continue;
+                    if (adaptive && err[l] > fTolerance && dt[l] > minStep)
+                        dt[l] = std::max(minStep, NextStep(dt[l], err[l], kFALSE));
+                    else
+                        pending[l] = kFALSE;
+                    nPending += pending[l];
+                }
+            }
+
+            active = 0;
+            for (Int_t l = 0; l < kLanes; l++)
+            {
+                if (!mask[l])
+                    continue;
+                x[l] = nx[l];
+                y[l] = ny[l];
+                z[l] = nz[l];
+                // Taking account of clouds widths
+                varLong[l] += dt[l] * twoDL;
+                varTransv[l] += dt[l] * twoDT * cteMod[l];
+                t[l] -= dt[l];
+                if (adaptive)
+                    step[l] = NextStep(dt[l], err[l], kTRUE);
+                mask[l] = t[l] > 0.;
+                active += mask[l];
+            }
+        }
+
+        for (Int_t l = 0; l < lanes; l++)
+        {
+            ele.x[first + l] = x[l];
+            ele.y[first + l] = y[l];
+            ele.z[first + l] = z[l];
+            ele.t[first + l] = t[l];
+            ele.varLong[first + l] = varLong[l];
+            ele.varTransv[first + l] = varTransv[l];
+        }
+    }
+}
@@ -0,0 +1,214 @@
+/******************************************************************************
+ *   Copyright (C) 2018 GSI Helmholtzzentrum für Schwerionenforschung GmbH    *
+ *   Copyright (C) 2018-2025 Members of R3B Collaboration                     *
+ *                                                                            *
+ *             This software is distributed under the terms of the            *
+ *                 GNU Lesser General Public Licence (LGPL) version 3,        *
+ *                    copied verbatim in the file "LICENSE".                  *
+ *                                                                            *
+ * In applying this license GSI does not waive the privileges and immunities  *
+ * granted to it by virtue of its status as an Intergovernmental Organization *
+ * or submit itself to any jurisdiction.                                      *
+ ******************************************************************************/
+
+/**  R3BGTPCDriftStepper.h
+ * Langevin drift of electron packets, forward to the pad plane and backward
+ * from it, shared by R3BGTPCLangevin, R3BGTPCLaserGen and R3BGTPCCal2Hit
+ **/
+
+#pragma once
+
+#include "R3BGTPCDriftParameters.h"
+#include "R3BGTPCFieldCache.h"
+#include "Rtypes.h"
+
+#include <atomic>
+#include <vector>
+
+class R3BGTPCRandom;
+
+/**
+ * GTPC drift stepper
+ *
+ * Electrons are kept as structure of arrays and advanced in packets of
+ * kLanes. The drift velocity and the step/diffusion values of a packet are
+ * computed together, with AVX-512 or AVX2 kernels when the library is
+ * compiled for them (e.g. -march=native) and a plain loop otherwise.
+ * Electrons that already reached their end point are masked and do not
+ * draw random numbers any more. The diffusion of each step is drawn with
+ * R3BGTPCRandom::ElectronGaus from the electron index and step number, so
+ * an electron gets the same numbers whatever its lane and kLanes.
+ *
+ * The deterministic part of a step can be integrated with the original fixed
+ * step scheme, with classical RK4 or with an adaptive Cash-Karp RK4(5) that
+ * keeps the position error of each step below a tolerance; in the adaptive
+ * case fDriftTimeStep is the largest step allowed. The diffusion of a step is
+ * added with the variance of the step actually taken.
+ *
+ * Where the field is parallel to the drift field (|B_x|,|B_z| below a
+ * tolerance times |B_y|) the Langevin velocity is just v along y, and an
+ * electron whose whole path lies in such voxels is moved to its end point in
+ * a single closed-form step, with the transversal diffusion reduced by the
+ * mean cteMod over the path. The transversal drift neglected is at most
+ * about tolerance times the drift length.
+ *
+ * Units as in R3BGTPCLangevin: [cm], [ns], [V/cm]; the field in [kG] from
+ * R3BGTPCFieldCache is moved to [V ns cm^-2].
+ */
+
+class R3BGTPCDriftStepper
+{
+  public:
+#if defined(__AVX512F__)
+    static constexpr Int_t kLanes = 8;
+#else
+    static constexpr Int_t kLanes = 4;
+#endif
+
+    /** Integration of the deterministic drift **/
+    enum EIntegrator
+    {
+        kEuler, //!< Fixed step: explicit Euler forward, two-evaluation predictor backward
+        kRK4,   //!< Fixed step classical Runge-Kutta
+        kRK45   //!< Adaptive step Cash-Karp Runge-Kutta 4(5)
+    };
+
+    /** Electrons to be drifted, one entry per electron **/
+    struct Electrons
+    {
+        std::vector<Double_t> x, y, z;   //!< Position [cm]
+        std::vector<Double_t> t;         //!< Time [ns]: accumulated (forward) or still to drift (backward)
+        std::vector<Double_t> varLong;   //!< Longitudinal cloud variance [cm^2] accumulated by the drift
+        std::vector<Double_t> varTransv; //!< Transversal cloud variance [cm^2] accumulated by the drift
+        std::vector<UInt_t> id;          //!< Electron index keying its diffusion draws, forward only
+
+        Int_t GetSize() const { return x.size(); }
+        void Clear();
+        /** Electron at (ex,ey,ez) and time et, with index eid (-1 its position in the arrays) **/
+        void Add(Double_t ex, Double_t ey, Double_t ez, Double_t et, Int_t eid = -1);
+    };
+
+    /** Constructor
+     *@param field    Field cache, must outlive the stepper
+     *@param par      Drift parameters
+     **/
+    R3BGTPCDriftStepper(const R3BGTPCFieldCache* field, const R3BGTPCDriftParameters& par);
+
+    /** Destructor **/
+    ~R3BGTPCDriftStepper() = default;
+
+    /** Drift until the pad plane (y=-fHalfSizeTPC_Y), adding the diffusion
+     ** of every step from the stream of rnd and the index of each electron.
+     ** Thread safe as long as each call has its own rnd **/
+    void DriftForward(Electrons& ele, R3BGTPCRandom& rnd) const;
+
+    /** Drift until the pad plane along the mean path, without diffusion;
+     ** the cloud variances are accumulated in varLong/varTransv **/
+    void DriftForwardMean(Electrons& ele) const;
+
+    /** Drift backwards from the pad plane during the time in ele.t, without
+     ** diffusion; the cloud variances are accumulated in varLong/varTransv **/
+    void DriftBackward(Electrons& ele) const;
+
+    /** Integrator and, for kRK45, largest position error per step [cm] **/
+    void SetIntegrator(EIntegrator integrator, Double_t tolerance = 1e-4);
+    EIntegrator GetIntegrator() const { return fIntegrator; }
+    Double_t GetTolerance() const { return fTolerance; }
+    static const char* GetIntegratorName(EIntegrator integrator);
+
+    /** Closed-form drift where |B_x|,|B_z| < tolerance*|B_y| along the whole
+     ** path of the electron. 0 (default) always uses the integrator **/
+    void SetParallelTolerance(Double_t tolerance);
+    Double_t GetParallelTolerance() const { return fParallelTolerance; }
+
+    /** Electrons drifted in closed form and step by step since construction **/
+    Long64_t GetNumberOfClosedForm() const { return fNClosedForm; }
+    Long64_t GetNumberOfStepped() const { return fNStepped; }
+    void LogStatistics(const char* owner) const;
+
+    const R3BGTPCDriftParameters& GetParameters() const { return fPar; }
+    const R3BGTPCFieldCache* GetFieldCache() const { return fField; }
+
+    /** Instruction set the kernels were compiled for **/
+    static const char* GetInstructionSet();
+
+  private:
+    const R3BGTPCFieldCache* fField;            //!< GLAD field on the drift volume
+    R3BGTPCDriftParameters fPar;                //!< Drift parameters
+    Double_t fMu;                               //!< Electron mobility [cm^2 ns^-1 V^-1]
+    EIntegrator fIntegrator;                    //!< Integrator of the deterministic drift. Default kEuler
+    Double_t fTolerance;                        //!< Largest position error per step for kRK45 [cm]
+    Double_t fParallelTolerance;                //!< Largest |B_transv|/|B_y| of the closed-form drift
+    std::vector<Int_t> fNonParallel;            //!< Non parallel nodes up to each node of a grid column, y fastest
+    mutable std::atomic<Long64_t> fNClosedForm; //!< Electrons drifted in closed form
+    mutable std::atomic<Long64_t> fNStepped;    //!< Electrons drifted step by step
+
+    /** Field [V ns cm^-2] for the lanes in mask **/
+    void GetField(const Double_t* x,
+                  const Double_t* y,
+                  const Double_t* z,
+                  const Bool_t* mask,
+                  Double_t* bx,
+                  Double_t* by,
+                  Double_t* bz) const;
+
+    /** Drift velocity [cm/ns] and the transversal reduction factor cteMod for a packet **/
+    void Velocity(const Double_t* bx,
+                  const Double_t* by,
+                  const Double_t* bz,
+                  Double_t* vx,
+                  Double_t* vy,
+                  Double_t* vz,
+                  Double_t* cteMod) const;
+
+    /** Forward step length [ns], including the last step adjustment before the pad
+     ** plane, and diffusion sigmas [cm] for a packet. Zero for lanes already there **/
+    void ForwardStep(const Double_t* y,
+                     const Double_t* vy,
+                     const Double_t* cteMod,
+                     Double_t* dt,
+                     Double_t* sigmaTransv,
+                     Double_t* sigmaLong) const;
+
+    /** Drift velocity along the motion, forward (sign=1) or backward (sign=-1) **/
+    void Derivative(const Double_t* x,
+                    const Double_t* y,
+                    const Double_t* z,
+                    const Bool_t* mask,
+                    Double_t sign,
+                    Double_t* kx,
+                    Double_t* ky,
+                    Double_t* kz,
+                    Double_t* cteMod) const;
+
+    /** Runge-Kutta step of dt for the lanes in mask, with the error estimate
+     ** [cm] (kRK45 only) and cteMod averaged as the velocity over the step.
+     ** The outputs of the lanes not in mask are left untouched **/
+    void RungeKuttaStep(const Double_t* x,
+                        const Double_t* y,
+                        const Double_t* z,
+                        const Double_t* dt,
+                        const Bool_t* mask,
+                        Double_t sign,
+                        Double_t* nx,
+                        Double_t* ny,
+                        Double_t* nz,
+                        Double_t* err,
+                        Double_t* cteMod) const;
+
+    /** Step to try after a step of dt with error err, for kRK45 **/
+    Double_t NextStep(Double_t dt, Double_t err, Bool_t accepted) const;
+
+    /** True if the field is parallel in the cells around the column x,z from yLow to yHigh **/
+    Bool_t IsParallel(Double_t x, Double_t z, Double_t yLow, Double_t yHigh) const;
+
+    /** Mean cteMod along the column x,z from yLow to yHigh **/
+    Double_t MeanCteMod(Double_t x, Double_t z, Double_t yLow, Double_t yHigh) const;
+
+    /** Forward drift, with the diffusion drawn from rnd or, if null, along the mean path **/
+    void Forward(Electrons& ele, R3BGTPCRandom* rnd) const;
+    void StepForward(Electrons& ele, R3BGTPCRandom* rnd) const;
+    void StepBackward(Electrons& ele) const;
+    void StepForwardRungeKutta(Electrons& ele, R3BGTPCRandom* rnd) const;
+    void StepBackwardRungeKutta(Electrons& ele) const;
+};
@@ -0,0 +1,170 @@
+/******************************************************************************
+ *   Copyright (C) 2018 GSI Helmholtzzentrum für Schwerionenforschung GmbH    *
+ *   Copyright (C) 2018-2025 Members of R3B Collaboration                     *
+ *                                                                            *
+ *             This software is distributed under the terms of the            *
+ *                 GNU Lesser General Public Licence (LGPL) version 3,        *
+ *                    copied verbatim in the file "LICENSE".                  *
+ *                                                                            *
+ * In applying this license GSI does not waive the privileges and immunities  *
+ * granted to it by virtue of its status as an Intergovernmental Organization *
+ * or submit itself to any jurisdiction.                                      *
+ ******************************************************************************/
+
+#include "R3BGTPCFieldCache.h"
+
+#include "FairField.h"
+#include "FairLogger.h"
+#include "FairRunAna.h"
+#include "FairRunSim.h"
+#include "TMath.h"
+
+#include <algorithm>
+#include <mutex>
+
+R3BGTPCFieldCache::R3BGTPCFieldCache(FairField* field, const Double_t* min, const Double_t* max, Double_t step)
+    : fField(field)
+    , fStep(step)
+    , fInvStep(1. / step)
+    , fChecksum(0.)
+{
+    for (Int_t c = 0; c < 3; c++)
+    {
+        fN[c] = (Int_t)std::ceil((max[c] - min[c]) * fInvStep) + 1;
+        if (fN[c] < 2)
+            fN[c] = 2;
+        fMin[c] = min[c];
+        fMax[c] = min[c] + (fN[c] - 1) * fStep;
+    }
+
+    fB.resize(3 * (size_t)fN[0] * fN[1] * fN[2]);
+    Double_t point[3];
+    Double_t B[3];
+    size_t node = 0;
+    for (Int_t k = 0; k < fN[2]; k++)
+    {
+        point[2] = fMin[2] + k * fStep;
+        for (Int_t j = 0; j < fN[1]; j++)
+        {
+            point[1] = fMin[1] + j * fStep;
+            for (Int_t i = 0; i < fN[0]; i++)
+            {
+                point[0] = fMin[0] + i * fStep;
+                fField->GetFieldValue(point, B); // [kG]
+                fB[node++] = B[0];
+                fB[node++] = B[1];
+                fB[node++] = B[2];
+                fChecksum += std::fabs(B[0]) + 2. * std::fabs(B[1]) + 3. * std::fabs(B[2]);
+            }
+        }
+    }
+
+    LOG(info) << "R3BGTPCFieldCache: GLAD field resampled on " << fN[0] << "x" << fN[1] << "x" << fN[2]
+              << " nodes (step " << fStep << " cm), x=[" << fMin[0] << "," << fMax[0] << "] y=[" << fMin[1] << ","
+              << fMax[1] << "] z=[" << fMin[2] << "," << fMax[2] << "] cm";
+}
+
+std::shared_ptr<R3BGTPCFieldCache> R3BGTPCFieldCache::Instance(R3BGTPCGeoPar* geoPar,
+                                                               FairField* field,
+                                                               Double_t step)
+{
+    static std::mutex instanceMutex;
+    static std::shared_ptr<R3BGTPCFieldCache> instance;
+
+    if (!geoPar || !field)
+    {
+        LOG(error) << "R3BGTPCFieldCache::Instance: No geometry parameters or no field map";
+        return nullptr;
+    }
+
+    Double_t halfX = geoPar->GetActiveRegionx() / 2.;
+    Double_t halfY = geoPar->GetActiveRegiony() / 2.;
+    Double_t halfZ = geoPar->GetActiveRegionz() / 2.;
+    Double_t offsetX = geoPar->GetGladOffsetX();
+    Double_t offsetZ = geoPar->GetGladOffsetZ();
+
+    // Pad plane as placed by Langevin and Projector
+    Double_t min[3] = { offsetX, -halfY, offsetZ };
+    Double_t max[3] = { offsetX + 2 * halfX, halfY, offsetZ + 2 * halfZ };
+
+    // Pad plane rotated into the field map frame as done in Cal2Hit and LaserGen
+    Double_t angle = kTPCAngle * TMath::Pi() / 180.;
+    for (Double_t xTPC : { 0., 2 * halfX })
+    {
+        for (Double_t zTPC : { 0., 2 * halfZ })
+        {
+            Double_t x = cos(-angle) * xTPC + sin(-angle) * zTPC;
+            Double_t z = (offsetZ - halfZ) - sin(-angle) * xTPC + cos(-angle) * zTPC;
+            min[0] = std::min(min[0], x);
+            max[0] = std::max(max[0], x);
+            min[2] = std::min(min[2], z);
+            max[2] = std::max(max[2], z);
+        }
+    }
+    for (Int_t c = 0; c < 3; c++)
+    {
+        min[c] -= kMargin;
+        max[c] += kMargin;
+    }
+
+    std::lock_guard<std::mutex> lock(instanceMutex);
+    if (instance && instance->fField == field && instance->fStep == step && instance->fMin[0] == min[0] &&
+        instance->fMin[1] == min[1] && instance->fMin[2] == min[2] && instance->fMax[0] >= max[0] &&
+        instance->fMax[1] >= max[1] && instance->fMax[2] >= max[2])
+        return instance;
+
+    instance = std::make_shared<R3BGTPCFieldCache>(field, min, max, step);
+    return instance;
+}
+
+FairField* R3BGTPCFieldCache::GetRunField()
+{
+    if (FairRunAna::Instance())
+        return FairRunAna::Instance()->GetField();
+    if (FairRunSim::Instance())
+        return FairRunSim::Instance()->GetField();
+    return nullptr;
+}
+
+Bool_t R3BGTPCFieldCache::IsInside(Double_t x, Double_t y, Double_t z) const
+{
+    return x >= fMin[0] && x < fMax[0] && y >= fMin[1] && y < fMax[1] && z >= fMin[2] && z < fMax[2];
+}
+
+void R3BGTPCFieldCache::GetNodeField(Int_t i, Int_t j, Int_t k, Double_t* B) const
+{
+    const Float_t* p = &fB[3 * (((size_t)k * fN[1] + j) * fN[0] + i)];
+    B[0] = p[0];
+    B[1] = p[1];
+    B[2] = p[2];
+}
+
+void R3BGTPCFieldCache::GetField(Double_t x, Double_t y, Double_t z, Double_t* B) const
+{
+    // Outside the grid the field of the nearest point of the grid: the field
+    // map is not thread safe and must not be queried by the drift threads
+    Double_t u = std::clamp((x - fMin[0]) * fInvStep, 0., fN[0] - 1.);
+    Double_t v = std::clamp((y - fMin[1]) * fInvStep, 0., fN[1] - 1.);
+    Double_t w = std::clamp((z - fMin[2]) * fInvStep, 0., fN[2] - 1.);
+    Int_t i = std::min((Int_t)u, fN[0] - 2);
+    Int_t j = std::min((Int_t)v, fN[1] - 2);
+    Int_t k = std::min((Int_t)w, fN[2] - 2);
+    Double_t fu = u - i;
+    Double_t fv = v - j;
+    Double_t fw = w - k;
+
+    const size_t sy = 3 * (size_t)fN[0];
+    const size_t sz = sy * fN[1];
+    const Float_t* p = &fB[k * sz + j * sy + 3 * (size_t)i];
+
+    for (Int_t c = 0; c < 3; c++)
+    {
+        Double_t b00 = p[c] + fu * (p[3 + c] - p[c]);
+        Double_t b10 = p[sy + c] + fu * (p[sy + 3 + c] - p[sy + c]);
+        Double_t b01 = p[sz + c] + fu * (p[sz + 3 + c] - p[sz + c]);
+        Double_t b11 = p[sz + sy + c] + fu * (p[sz + sy + 3 + c] - p[sz + sy + c]);
+        Double_t b0 = b00 + fv * (b10 - b00);
+        Double_t b1 = b01 + fv * (b11 - b01);
+        B[c] = b0 + fw * (b1 - b0);
+    }
+}
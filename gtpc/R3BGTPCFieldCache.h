@@ -0,0 +1,99 @@
+/******************************************************************************
+ *   Copyright (C) 2018 GSI Helmholtzzentrum für Schwerionenforschung GmbH    *
+ *   Copyright (C) 2018-2025 Members of R3B Collaboration                     *
+ *                                                                            *
+ *             This software is distributed under the terms of the            *
+ *                 GNU Lesser General Public Licence (LGPL) version 3,        *
+ *                    copied verbatim in the file "LICENSE".                  *
+ *                                                                            *
+ * In applying this license GSI does not waive the privileges and immunities  *
+ * granted to it by virtue of its status as an Intergovernmental Organization *
+ * or submit itself to any jurisdiction.                                      *
+ ******************************************************************************/
+
+/**  R3BGTPCFieldCache.h
+ * Regular grid copy of the GLAD field map over the GTPC drift volume, used by
+ * the drift kernels instead of querying R3BGladFieldMap at every step
+ **/
+
+#pragma once
+
+#include "R3BGTPCGeoPar.h"
+#include "Rtypes.h"
+
+#include <memory>
+#include <vector>
+
+class FairField;
+
+/**
+ * GTPC field cache
+ *
+ * The GLAD map is resampled once per run on a regular grid covering the
+ * active region (both the Langevin/Projector placement of the pad plane and
+ * the rotated one used by Cal2Hit and LaserGen, plus a margin for the
+ * transverse drift). Bx, By and Bz are stored interleaved per node, so a
+ * single trilinear interpolation returns the three components. Queries
+ * outside the grid take the field of the nearest point of the grid: the
+ * field map is only read by the constructor, so a cache can be shared by
+ * threads.
+ *
+ * Units follow R3BGladFieldMap: positions in [cm], field in [kG].
+ */
+
+class R3BGTPCFieldCache
+{
+  public:
+    /** Constructor
+     *@param field    Field map to be resampled
+     *@param min      Lower corner of the cached box [cm]
+     *@param max      Upper corner of the cached box [cm]
+     *@param step     Grid spacing [cm]
+     **/
+    R3BGTPCFieldCache(FairField* field, const Double_t* min, const Double_t* max, Double_t step);
+
+    /** Destructor **/
+    ~R3BGTPCFieldCache() = default;
+
+    /** Cache shared by all GTPC tasks for the geometry in geoPar. It is built
+     ** on the first call and rebuilt only if the field or region changes **/
+    static std::shared_ptr<R3BGTPCFieldCache> Instance(R3BGTPCGeoPar* geoPar,
+                                                       FairField* field,
+                                                       Double_t step = kDefaultStep);
+
+    /** Field of the present run, analysis or simulation (chained digitization) **/
+    static FairField* GetRunField();
+
+    /** Field components [kG] at (x,y,z) [cm] in B[0..2], clamped to the grid **/
+    void GetField(Double_t x, Double_t y, Double_t z, Double_t* B) const;
+
+    /** Field components [kG] at the grid node (i,j,k) in B[0..2] **/
+    void GetNodeField(Int_t i, Int_t j, Int_t k, Double_t* B) const;
+
+    /** True if (x,y,z) [cm] is covered by the grid **/
+    Bool_t IsInside(Double_t x, Double_t y, Double_t z) const;
+
+    /** Sum over the grid, used to tag tables derived from this field **/
+    Double_t GetChecksum() const { return fChecksum; }
+
+    Double_t GetStep() const { return fStep; }
+    Int_t GetNx() const { return fN[0]; }
+    Int_t GetNy() const { return fN[1]; }
+    Int_t GetNz() const { return fN[2]; }
+    const Double_t* GetMin() const { return fMin; }
+    const Double_t* GetMax() const { return fMax; }
+
+    static constexpr Double_t kDefaultStep = 0.5; //!< Default grid spacing [cm]
+    static constexpr Double_t kMargin = 2.;       //!< Margin around the active region [cm]
+    static constexpr Double_t kTPCAngle = 14.;    //!< TPC rotation used by Cal2Hit and LaserGen [deg]
+
+  private:
+    FairField* fField;       //!< Field map the grid was filled from
+    Double_t fMin[3];        //!< Lower corner of the grid [cm]
+    Double_t fMax[3];        //!< Upper corner of the grid [cm]
+    Double_t fStep;          //!< Grid spacing [cm]
+    Double_t fInvStep;       //!< 1/fStep [cm^-1]
+    Int_t fN[3];             //!< Number of nodes in x, y, z
+    Double_t fChecksum;      //!< Weighted sum of the field components on the grid [kG]
+    std::vector<Float_t> fB; //!< Bx,By,Bz per node, x running fastest [kG]
+};
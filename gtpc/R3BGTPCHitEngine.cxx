@@ -0,0 +1,214 @@
+/******************************************************************************
+ *   Copyright (C) 2018 GSI Helmholtzzentrum für Schwerionenforschung GmbH    *
+ *   Copyright (C) 2018-2025 Members of R3B Collaboration                     *
+ *                                                                            *
+ *             This software is distributed under the terms of the            *
+ *                 GNU Lesser General Public Licence (LGPL) version 3,        *
+ *                    copied verbatim in the file "LICENSE".                  *
+ *                                                                            *
+ * In applying this license GSI does not waive the privileges and immunities  *
+ * granted to it by virtue of its status as an Intergovernmental Organization *
+ * or submit itself to any jurisdiction.                                      *
+ ******************************************************************************/
+
+#include "R3BGTPCHitEngine.h"
+#include "R3BGTPCBackDriftMap.h"
+#include "R3BGTPCCalData.h"
+#include "R3BGTPCHitData.h"
+
+#include "FairLogger.h"
+#include "TClonesArray.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+R3BGTPCHitEngine::R3BGTPCHitEngine(const Parameters& par,
+                                   std::shared_ptr<const R3BGTPCPadGeometry> padPlane,
+                                   std::shared_ptr<const R3BGTPCFieldCache> field,
+                                   std::shared_ptr<const R3BGTPCDriftStepper> stepper,
+                                   std::shared_ptr<const R3BGTPCBackDriftMap> backDriftMap)
+    : fPar(par)
+    , fPadPlane(std::move(padPlane))
+    , fField(std::move(field))
+    , fStepper(std::move(stepper))
+    , fBackDriftMap(std::move(backDriftMap))
+{
+    if (fPar.fLangevinBack && !fStepper)
+        LOG(fatal) << "R3BGTPCHitEngine: No stepper for the back drift";
+}
+
+void R3BGTPCHitEngine::DriftBack(Double_t z,
+                                 Double_t x,
+                                 const Double_t* times,
+                                 Int_t n,
+                                 Double_t* out,
+                                 Workspace& ws) const
+{
+    // from create_tpc_geo_test.C (geo in file
+    // R3BRoot/glad-tpc/geometry/gladTPC_test.geo.root)
+    Double_t TargetOffsetZ_FM = fPar.fFieldOffsetZ; // USING THE FIELD MAP DESPLACEMENT! MISMATCH
+    Double_t TargetAngle = fPar.fTargetAngle;
+
+    // Transformation from tcp coordinates to glad coordinates
+    Double_t xField = cos(-TargetAngle) * x + sin(-TargetAngle) * z;
+    Double_t zField = (TargetOffsetZ_FM - fPar.fHalfSizeTPC_Z) - sin(-TargetAngle) * x + cos(-TargetAngle) * z;
+
+    auto& electrons = ws.electrons;
+    electrons.Clear();
+    for (Int_t b = 0; b < n; b++)
+        electrons.Add(xField, -fPar.fHalfSizeTPC_Y, zField, times[b]); // Start at pad plane
+
+    // Reconstruction with Langevin: calculation loop till the drift time is 0,
+    // taking account of the clouds widths
+    fStepper->DriftBackward(electrons);
+
+    for (Int_t b = 0; b < n; b++)
+    {
+        Double_t xnew = electrons.x[b];
+        Double_t znew = electrons.z[b];
+        Double_t* values = out + b * R3BGTPCBackDriftMap::kNQuantities;
+
+        // Back to tpc coordinates
+        values[R3BGTPCBackDriftMap::kX] =
+            +cos(TargetAngle) * xnew + sin(TargetAngle) * (znew - (TargetOffsetZ_FM - fPar.fHalfSizeTPC_Z));
+        values[R3BGTPCBackDriftMap::kY] = electrons.y[b];
+        values[R3BGTPCBackDriftMap::kZ] =
+            -sin(TargetAngle) * xnew + cos(TargetAngle) * (znew - (TargetOffsetZ_FM - fPar.fHalfSizeTPC_Z));
+        values[R3BGTPCBackDriftMap::kSigmaLong] = sqrt(electrons.varLong[b]);
+        values[R3BGTPCBackDriftMap::kSigmaTransv] = sqrt(electrons.varTransv[b]);
+    }
+}
+
+void R3BGTPCHitEngine::MakeHits(const TClonesArray& cal, TClonesArray& hits, Workspace& ws) const
+{
+    Int_t nCals = cal.GetEntries();
+
+    const Int_t nQuantities = R3BGTPCBackDriftMap::kNQuantities;
+    auto& bucketCounts = ws.counts;
+    auto& bucketTimes = ws.times;
+    auto& values = ws.values;
+
+    for (Int_t i = 0; i < nCals; i++)
+    {
+        auto calData = (R3BGTPCCalData*)cal.At(i);
+        UShort_t pad = calData->GetPadId();
+
+        // Invalid ID condition (Should be solved in R3BGTPCLangevin)
+        if (!fPadPlane->IsValid(pad))
+        {
+            LOG(warn) << "R3BGTPCHitEngine: Invalid padID " << pad;
+            continue;
+        }
+
+        Double_t sigmaLong = 0; // aprox for the whole time of reconstruction
+        Double_t sigmaTransv = 0;
+
+        // To store all the hit weighted mean variables
+        Double_t pad_counts = 0;
+        Double_t hitx = 0;
+        Double_t hity = 0;
+        Double_t hitz = 0;
+        Double_t hitlW = 0;
+
+        Double_t padCenterZ, padCenterX;
+        fPadPlane->GetPadCenter(pad, padCenterZ, padCenterX);
+
+        Double_t z = padCenterZ / 10.0; //[cm] (pad center on mm)
+        Double_t x = padCenterX / 10.0;
+
+        bucketCounts.clear();
+        bucketTimes.clear();
+        // Only the non zero time buckets, dense or zero suppressed data
+        for (const auto sample : calData->GetSamples())
+        {
+            Double_t time = sample.bucket; //[timeBuckets]
+
+            time = time * fPar.fTimeBinSize + 0.5 * fPar.fTimeBinSize; //[ns] moving from TimeBuckets to ns; adding
+                                                                       // the half of the size of the bin to take
+                                                                       // the center of the bin
+            bucketCounts.push_back(sample.adc);
+            bucketTimes.push_back(time);
+        }
+        Int_t nBuckets = bucketTimes.size();
+
+        // No charge to weight the mean with, e.g. a zero suppressed trace
+        // with no sample left
+        if (std::accumulate(bucketCounts.begin(), bucketCounts.end(), 0.) <= 0.)
+            continue;
+
+        // Start point of the electrons of each bucket: from the table, drifted
+        // back step by step (also the buckets later than the table, e.g.
+        // noise after the full drift length), or (without Langevin) moved
+        // along y only
+        values.resize((size_t)nQuantities * nBuckets);
+        if (fPar.fLangevinBack && fBackDriftMap)
+        {
+            ws.lateBuckets.clear();
+            ws.lateTimes.clear();
+            for (Int_t b = 0; b < nBuckets; b++)
+            {
+                if (fBackDriftMap->IsInside(z, x, bucketTimes[b]))
+                {
+                    fBackDriftMap->GetValues(z, x, bucketTimes[b], &values[b * nQuantities]);
+                }
+                else
+                {
+                    ws.lateBuckets.push_back(b);
+                    ws.lateTimes.push_back(bucketTimes[b]);
+                }
+            }
+            Int_t nLate = ws.lateBuckets.size();
+            if (nLate > 0)
+            {
+                ws.lateValues.resize((size_t)nQuantities * nLate);
+                DriftBack(z, x, ws.lateTimes.data(), nLate, ws.lateValues.data(), ws);
+                for (Int_t l = 0; l < nLate; l++)
+                    std::copy_n(&ws.lateValues[l * nQuantities], nQuantities, &values[ws.lateBuckets[l] * nQuantities]);
+            }
+        }
+        else if (fPar.fLangevinBack)
+        {
+            DriftBack(z, x, bucketTimes.data(), nBuckets, values.data(), ws);
+        }
+
+        for (Int_t b = 0; b < nBuckets; b++)
+        {
+            Double_t counts = bucketCounts[b];
+            Double_t time = bucketTimes[b];
+            const Double_t* start = &values[b * nQuantities];
+
+            // Reconstruction without Langevin
+            if (fPar.fLangevinBack == kFALSE)
+            {
+                // [cm] Simple projection case -> Same x,z just moving in coord y
+                hitx += x * counts;
+                hity += (-fPar.fHalfSizeTPC_Y + time * fPar.fDriftVelocity) * counts;
+                hitz += z * counts;
+            }
+            // Reconstruction with Langevin
+            if (fPar.fLangevinBack == kTRUE)
+            {
+                sigmaLong = sqrt(time * 2 * fPar.fLongDiff);
+                sigmaTransv = sqrt(time * 2 * fPar.fTransDiff);
+                // Comparing sigmas obtained in both ways
+                LOG(debug) << "Comparing sigmas... Approx: " << sigmaLong << " " << sigmaTransv
+                           << ";  Step by step: " << start[R3BGTPCBackDriftMap::kSigmaLong] << " "
+                           << start[R3BGTPCBackDriftMap::kSigmaTransv];
+
+                hitx += start[R3BGTPCBackDriftMap::kX] * counts;
+                hity += start[R3BGTPCBackDriftMap::kY] * counts;
+                hitz += start[R3BGTPCBackDriftMap::kZ] * counts;
+            }
+            // Adding the hit relevant info for the mean
+            hitlW += sigmaLong * counts;
+            pad_counts += counts;
+        }
+        // Final Hit values calculated by weighted mean
+        hitx = hitx / pad_counts;
+        hity = hity / pad_counts;
+        hitz = hitz / pad_counts;
+        hitlW = hitlW / pad_counts;
+        new (hits[hits.GetEntriesFast()]) R3BGTPCHitData(hitx, hity, hitz, hitlW, pad_counts);
+    }
+}
@@ -0,0 +1,119 @@
+/******************************************************************************
+ *   Copyright (C) 2018 GSI Helmholtzzentrum für Schwerionenforschung GmbH    *
+ *   Copyright (C) 2018-2025 Members of R3B Collaboration                     *
+ *                                                                            *
+ *             This software is distributed under the terms of the            *
+ *                 GNU Lesser General Public Licence (LGPL) version 3,        *
+ *                    copied verbatim in the file "LICENSE".                  *
+ *                                                                            *
+ * In applying this license GSI does not waive the privileges and immunities  *
+ * granted to it by virtue of its status as an Intergovernmental Organization *
+ * or submit itself to any jurisdiction.                                      *
+ ******************************************************************************/
+
+/**  R3BGTPCHitEngine.h
+ * Hit making kernel of R3BGTPCCal2Hit: one hit per pad from the time buckets
+ * drifted back from the pad plane, without any state of its own between events
+ **/
+
+#pragma once
+
+#include "R3BGTPCDriftStepper.h"
+#include "R3BGTPCFieldCache.h"
+#include "R3BGTPCPadGeometry.h"
+#include "Rtypes.h"
+#include "TMath.h"
+
+#include <memory>
+#include <vector>
+
+class R3BGTPCBackDriftMap;
+class TClonesArray;
+
+/**
+ * GTPC hit engine
+ *
+ * Same sharing rules as R3BGTPCLangevinEngine: parameters by value, the
+ * read-only pad plane and stepper through shared pointers, const methods and
+ * a Workspace per event stream.
+ *
+ * The pad centers are taken with the pad plane at the origin of the TPC
+ * frame and moved to the field map frame with fTargetAngle and fFieldOffsetZ.
+ *
+ * The back drift of a sample only depends on its pad and time, so it can be
+ * taken from a R3BGTPCBackDriftMap built once with DriftBack instead of
+ * stepping every sample of every event.
+ */
+
+class R3BGTPCHitEngine
+{
+  public:
+    /** Values of the parameter containers and task settings used per event **/
+    struct Parameters
+    {
+        Double_t fHalfSizeTPC_Y = 0.;                    //!< Half size Y of the TPC drift volume [cm]
+        Double_t fHalfSizeTPC_Z = 0.;                    //!< Half size Z of the TPC drift volume [cm]
+        Double_t fTimeBinSize = 0.;                      //!< Time size of each bin of R3BGTPCCalData [ns]
+        Int_t fNTimeBins = 512;                          //!< Time bins of R3BGTPCCalData
+        Double_t fDriftVelocity = 0.;                    //!< Drift velocity in gas [cm/ns]
+        Double_t fLongDiff = 0.;                         //!< Longitudinal diffusion coefficient [cm^2/ns]
+        Double_t fTransDiff = 0.;                        //!< Transversal diffusion coefficient [cm^2/ns]
+        Double_t fFieldOffsetZ = 0.;                     //!< Z of the TPC in the field map [cm]
+        Double_t fTargetAngle = 14. * TMath::DegToRad(); //!< Angle of the TPC in the field map [rad]
+        Bool_t fLangevinBack = kTRUE;                    //!< Drift back with the stepper, else along y only
+    };
+
+    /** Memory of an event stream, reused from one event to the next **/
+    struct Workspace
+    {
+        R3BGTPCDriftStepper::Electrons electrons; //!< Time buckets of a pad, drifted back together
+        std::vector<Double_t> counts;             //!< Charge of each bucket
+        std::vector<Double_t> times;              //!< Time of each bucket [ns]
+        std::vector<Double_t> values;             //!< Drifted back values of each bucket
+        std::vector<Int_t> lateBuckets;           //!< Buckets later than the back drift map
+        std::vector<Double_t> lateTimes;          //!< Time of each of the late buckets [ns]
+        std::vector<Double_t> lateValues;         //!< Drifted back values of each of the late buckets
+    };
+
+    /** Constructor
+     *@param par          Parameters, copied
+     *@param padPlane     Pad plane geometry
+     *@param field        Field cache the stepper was built on, nullptr without back drift
+     *@param stepper      Langevin stepper of the back drift, nullptr without back drift
+     *@param backDriftMap Back drift table built for these settings, nullptr to always step
+     **/
+    R3BGTPCHitEngine(const Parameters& par,
+                     std::shared_ptr<const R3BGTPCPadGeometry> padPlane,
+                     std::shared_ptr<const R3BGTPCFieldCache> field = nullptr,
+                     std::shared_ptr<const R3BGTPCDriftStepper> stepper = nullptr,
+                     std::shared_ptr<const R3BGTPCBackDriftMap> backDriftMap = nullptr);
+
+    /** Destructor **/
+    ~R3BGTPCHitEngine() = default;
+
+    /** New workspace for an event stream **/
+    std::unique_ptr<Workspace> MakeWorkspace() const { return std::make_unique<Workspace>(); }
+
+    /** Add to hits (R3BGTPCHitData) one hit per R3BGTPCCalData of cal with a
+     ** valid pad and some charge **/
+    void MakeHits(const TClonesArray& cal, TClonesArray& hits, Workspace& ws) const;
+
+    /** Drift back with the stepper from the point (z,x) [cm] of the pad plane
+     ** during each of the n times [ns]: R3BGTPCBackDriftMap::kNQuantities
+     ** values per time in out, the start point in the TPC frame and the
+     ** widths of the cloud **/
+    void DriftBack(Double_t z, Double_t x, const Double_t* times, Int_t n, Double_t* out, Workspace& ws) const;
+
+    const Parameters& GetParameters() const { return fPar; }
+    const R3BGTPCPadGeometry& GetPadPlane() const { return *fPadPlane; }
+    const R3BGTPCFieldCache* GetField() const { return fField.get(); }
+    const R3BGTPCDriftStepper* GetStepper() const { return fStepper.get(); }
+    const R3BGTPCBackDriftMap* GetBackDriftMap() const { return fBackDriftMap.get(); }
+
+  private:
+    const Parameters fPar;                                    //!< Parameters
+    std::shared_ptr<const R3BGTPCPadGeometry> fPadPlane;      //!< Pad plane geometry
+    std::shared_ptr<const R3BGTPCFieldCache> fField;          //!< GLAD field, kept alive for the stepper
+    std::shared_ptr<const R3BGTPCDriftStepper> fStepper;      //!< Langevin stepper for the back drift
+    std::shared_ptr<const R3BGTPCBackDriftMap> fBackDriftMap; //!< Back drift table, if in lookup mode
+};
@@ -20,15 +20,22 @@
 
 #include "FairTask.h"
 #include "R3BGTPCCalData.h"
+#include "R3BGTPCDriftMap.h"
+#include "R3BGTPCDriftStepper.h"
 #include "R3BGTPCElecPar.h"
+#include "R3BGTPCFieldCache.h"
 #include "R3BGTPCGasPar.h"
 #include "R3BGTPCGeoPar.h"
-#include "R3BGTPCMap.h"
+#include "R3BGTPCLangevinEngine.h"
+#include "R3BGTPCPadGeometry.h"
+#include "R3BGTPCPipeline.h"
 #include "R3BGTPCPoint.h"
 #include "R3BGTPCProjPoint.h"
 #include "TClonesArray.h"
 #include "TVirtualMC.h"
 
+#include <vector>
+
 /**
  * GTPC drift calculation using Langevin equation task
  * @author Héctor Alvarez Pol
@@ -37,6 +44,8 @@
  * plane Input:  Branch GTPCPoints = TClonesArray("R3BGTPCPoint") Output: Branch
  * GTPCCalData = TClonesArray("R3BGTPCCalData") Output: Branch GTPCProjPoint =
  * TClonesArray("R3BGTPCProjPoint")
+ * Input alternatively from the compact Branch GTPCCompactPoint =
+ * TClonesArray("R3BGTPCCompactPoint"), see R3BGTPC::SetCompactPoints
  */
 
 class R3BGTPCLangevin : public FairTask
@@ -54,6 +63,10 @@ class R3BGTPCLangevin : public FairTask
     /** Virtual method Exec **/
     void Exec(Option_t*);
 
+    /** Exec on the arrays of an event of R3BGTPCPipeline: GTPCPoint (or
+     ** GTPCCompactPoint), MCTrack and the GTPCCalData or GTPCProjPoint output **/
+    void ExecEvent(R3BGTPCPipelineEvent& event);
+
     /** Virtual method ReInit **/
     virtual InitStatus ReInit();
 
@@ -68,6 +81,63 @@ class R3BGTPCLangevin : public FairTask
     void SetProjPointsAsOutput() { outputMode = 1; }
     void SetCalDataAsOutput() { outputMode = 0; }
 
+    /** Accessor to select online mode: the output is kept in memory for the
+     ** following tasks and not stored. Default kFALSE **/
+    void SetOnline(Bool_t option) { fOnline = option; }
+
+    /** Store in each R3BGTPCCalData only its non-zero time buckets, when it
+     ** takes less space. Default kTRUE **/
+    void SetZeroSuppressedCalData(Bool_t suppress) { fZeroSuppress = suppress; }
+
+    /** Drift the ionization electrons in bunches of n, each bunch as a single
+     ** carrier weighting n in the output, started at a random place of the
+     ** part of the step its electrons come from. Default 1 (every electron) **/
+    void SetElectronsPerBunch(Int_t n) { fElectronsPerBunch = n > 1 ? n : 1; }
+
+    /** Drift at most n carriers per point: the electrons of a larger point are
+     ** drifted in bunches of ceil(electrons/n), each weighting its size, so the
+     ** total charge is kept. Default 0 (no cap) **/
+    void SetMaxCarriersPerPoint(Int_t n) { fMaxCarriersPerPoint = n; }
+
+    /** Drift about n carriers per event at most: above it the number of
+     ** carriers of every point is reduced by the same factor. The budget is
+     ** not a hard bound, as every point with electrons keeps at least one
+     ** carrier: it can be exceeded by up to one carrier per point, and an
+     ** event with more points than n drifts one carrier per point.
+     ** Default 0 (no budget) **/
+    void SetMaxCarriersPerEvent(Long64_t n) { fMaxCarriersPerEvent = n; }
+
+    /** Drift each electron with a single lookup in a precomputed transfer map
+     ** instead of the step loop. The map is read from (or written to) dir **/
+    void SetDriftMapMode(Bool_t mode) { fUseDriftMap = mode; }
+    void SetDriftMapDir(TString dir) { fDriftMapDir = dir; }
+    void SetDriftMapStep(Double_t step) { fDriftMapStep = step; }
+
+    /** Seed of the random streams of the run, keyed then by event ID and point
+     ** (see R3BGTPCRandom). Default 0: drawn from gRandom in Init **/
+    void SetRunSeed(ULong64_t seed) { fRunSeed = seed; }
+
+    /** Number of threads drifting the electrons of an event. Default 1,
+     ** 0 uses all the available cores. They are started with the first
+     ** event and kept for the whole run **/
+    void SetNumberOfThreads(Int_t n) { fNumberOfThreads = n; }
+
+    /** Integrator of the drift. With R3BGTPCDriftStepper::kRK45 the drift time
+     ** step is the largest step and tolerance the position error per step [cm] **/
+    void SetDriftIntegrator(R3BGTPCDriftStepper::EIntegrator integrator, Double_t tolerance = 1e-4)
+    {
+        fIntegrator = integrator;
+        fIntegratorTolerance = tolerance;
+    }
+
+    /** Drift in a single closed-form step where |B_x|,|B_z| < tolerance*|B_y|
+     ** along the whole path of the electron. Default 0 (always step) **/
+    void SetParallelFieldTolerance(Double_t tolerance) { fParallelTolerance = tolerance; }
+
+    /** Digitization kernel built in Init/ReInit. It can be shared with other
+     ** threads digitizing their own events, each with its own workspace **/
+    const R3BGTPCLangevinEngine* GetEngine() const { return fEngine.get(); }
+
   private:
     // Mapping of  virtualPadID to ProjPoint object pointer
     // std::map<Int_t, R3BGTPCProjPoint*> fProjPointMap;
@@ -96,8 +166,19 @@ class R3BGTPCLangevin : public FairTask
     R3BGTPCGasPar* fGTPCGasPar;   //!< Gas parameter container
     R3BGTPCElecPar* fGTPCElecPar; //!< Electronic parameter container
 
-    Int_t outputMode; //!< Selects Cal(0) or ProjPoint(1) as output level. Default 0
+    Int_t outputMode;                             //!< Selects Cal(0) or ProjPoint(1) as output level. Default 0
+    Bool_t fZeroSuppress;                         //!< Zero suppressed R3BGTPCCalData. Default kTRUE
+    Bool_t fOnline;                               //!< Output not stored. Default kFALSE
+    Int_t fElectronsPerBunch;                     //!< Electrons drifted together as one carrier. Default 1
+    Int_t fMaxCarriersPerPoint;                   //!< Carriers drifted per point at most. Default 0 (no cap)
+    Long64_t fMaxCarriersPerEvent;                //!< Carriers drifted per event at most. Default 0 (no budget)
+    Int_t fNumberOfThreads;                       //!< Threads used for the drift. Default 1
+    ULong64_t fRunSeed;                           //!< Seed of the random streams of the run
+    R3BGTPCDriftStepper::EIntegrator fIntegrator; //!< Drift integrator. Default kEuler
+    Double_t fIntegratorTolerance;                //!< Position error per step for kRK45 [cm]
+    Double_t fParallelTolerance;                  //!< Largest |B_transv|/|B_y| of the closed-form drift
     TClonesArray* fGTPCPointsCA;
+    TClonesArray* fGTPCCompactPointsCA;
     TClonesArray* fGTPCCalDataCA;
     TClonesArray* fGTPCProjPointCA;
     // MCTrack- vertex information
@@ -105,8 +186,22 @@ class R3BGTPCLangevin : public FairTask
 
     // R3BGTPCCalData* AddCalData();
 
-    std::shared_ptr<R3BGTPCMap> fTPCMap; //!< Map container
-    TH2Poly* fPadPlane;                  //!< Pad Plane object
+    std::shared_ptr<const R3BGTPCPadGeometry> fPadGeometry; //!< Pad plane geometry
+    std::shared_ptr<R3BGTPCFieldCache> fFieldCache;         //!< GLAD field resampled over the drift volume
+
+    Bool_t fUseDriftMap;                                          //!< Lookup-table drift, no stepping. Default kFALSE
+    TString fDriftMapDir;                                         //!< Directory of the drift map files. Default "."
+    Double_t fDriftMapStep;                                       //!< Grid spacing of the drift map [cm]. Default 0.2
+    std::shared_ptr<R3BGTPCDriftMap> fDriftMap;                   //!< Drift transfer map, if in lookup mode
+    std::shared_ptr<R3BGTPCDriftStepper> fStepper;                //!< Langevin stepper for electron packets
+    std::unique_ptr<R3BGTPCLangevinEngine> fEngine;               //!< Digitization kernel of the current parameters
+    std::unique_ptr<R3BGTPCLangevinEngine::Workspace> fWorkspace; //!< Memory of the events of this task
+
+    R3BGTPCDriftParameters GetDriftParameters() const;
+    InitStatus InitDriftMap();
+
+    /** Engine (and workspace) for the current parameters, field and drift map **/
+    void InitEngine();
 
     ClassDef(R3BGTPCLangevin, 2)
 };
@@ -0,0 +1,435 @@
+/******************************************************************************
+ *   Copyright (C) 2018 GSI Helmholtzzentrum für Schwerionenforschung GmbH    *
+ *   Copyright (C) 2018-2025 Members of R3B Collaboration                     *
+ *                                                                            *
+ *             This software is distributed under the terms of the            *
+ *                 GNU Lesser General Public Licence (LGPL) version 3,        *
+ *                    copied verbatim in the file "LICENSE".                  *
+ *                                                                            *
+ * In applying this license GSI does not waive the privileges and immunities  *
+ * granted to it by virtue of its status as an Intergovernmental Organization *
+ * or submit itself to any jurisdiction.                                      *
+ ******************************************************************************/
+
+#include "R3BGTPCLangevinEngine.h"
+#include "R3BGTPCCalData.h"
+#include "R3BGTPCPoint.h"
+#include "R3BGTPCProjPoint.h"
+#include "R3BMCTrack.h"
+
+#include "FairLogger.h"
+#include "TClonesArray.h"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+R3BGTPCLangevinEngine::R3BGTPCLangevinEngine(const Parameters& par,
+                                             std::shared_ptr<const R3BGTPCPadGeometry> padPlane,
+                                             std::shared_ptr<const R3BGTPCFieldCache> field,
+                                             std::shared_ptr<const R3BGTPCDriftStepper> stepper,
+                                             std::shared_ptr<const R3BGTPCDriftMap> driftMap)
+    : fPar(par)
+    , fPadPlane(std::move(padPlane))
+    , fField(std::move(field))
+    , fStepper(std::move(stepper))
+    , fDriftMap(std::move(driftMap))
+{
+}
+
+std::unique_ptr<R3BGTPCLangevinEngine::Workspace> R3BGTPCLangevinEngine::MakeWorkspace() const
+{
+    return std::make_unique<Workspace>(fPadPlane->GetNumberOfPads(), fPar.fNTimeBins);
+}
+
+namespace
+{
+    // Bunch size of n electrons for at most maxCarriers carriers (<= 0: no limit)
+    Int_t BunchSize(Int_t electronsPerBunch, Int_t n, Long64_t maxCarriers)
+    {
+        Int_t size = electronsPerBunch;
+        if (maxCarriers > 0 && n > size * maxCarriers)
+            size = (n + maxCarriers - 1) / maxCarriers;
+        return size;
+    }
+
+    Long64_t Carriers(const R3BGTPCLangevinEngine::DriftSegment& segment)
+    {
+        if (segment.generatedElectrons <= 0)
+            return 0;
+        return (segment.generatedElectrons + segment.electronsPerBunch - 1) / segment.electronsPerBunch;
+    }
+} // namespace
+
+void R3BGTPCLangevinEngine::MakeSegments(const TClonesArray& points,
+                                         const TClonesArray& mcTracks,
+                                         R3BGTPCRandom& fanoRnd,
+                                         Workspace& ws) const
+{
+    auto& segments = ws.segments;
+    segments.clear();
+
+    Int_t nPoints = points.GetEntries();
+    R3BGTPCPoint* aPoint;
+    Int_t presentTrackID = -10; // control of the point trackID
+    Double_t xPre = 0., yPre = 0., zPre = 0.;
+    Bool_t readyToProject = kFALSE;
+    Int_t electrons = 0;
+    Int_t flucElectrons = 0;
+    Int_t PDGCode = 0, MotherId = 0;
+    Double_t Vertex_x0 = 0, Vertex_y0 = 0, Vertex_z0 = 0, Vertex_px0 = 0, Vertex_py0 = 0, Vertex_pz0 = 0;
+    for (Int_t i = 0; i < nPoints; i++)
+    {
+        aPoint = (R3BGTPCPoint*)points.At(i);
+        if (aPoint->GetTrackStatus() == 11000 || aPoint->GetTrackStatus() == 10010010 ||
+            aPoint->GetTrackStatus() == 10010000 || aPoint->GetTrackStatus() == 10011000)
+        {
+            // entering the gas volume or new track inside the gas (is 10010010 or
+            // 10010000??)
+            presentTrackID = aPoint->GetTrackID();
+            // from gMC->TrackPosition() -> current position in the master reference
+            // frame of the track
+            xPre = aPoint->GetX();
+            yPre = aPoint->GetY();
+            zPre = aPoint->GetZ();
+            R3BMCTrack* Track = (R3BMCTrack*)mcTracks.At(presentTrackID);
+            PDGCode = Track->GetPdgCode();
+            MotherId = Track->GetMotherId();
+            Vertex_x0 = Track->GetStartX();
+            Vertex_y0 = Track->GetStartY();
+            Vertex_z0 = Track->GetStartZ();
+            Vertex_px0 = Track->GetPx();
+            Vertex_py0 = Track->GetPy();
+            Vertex_pz0 = Track->GetPz();
+            readyToProject = kTRUE;
+            continue; // no energy deposited in this point, just taking in entrance
+                      // coordinates
+                      // NOTE: the entering points deposit no energy but is used as start point
+                      // for the calculation of the track portion where energy is used in a
+                      // regular electron ionization below
+        }
+        // any other case, that is, other than entering the volume
+        if (presentTrackID != aPoint->GetTrackID())
+        { // track was not entering the volume in a
+          // previous point, what somehow it is in! :‑O
+            LOG(fatal) << "R3BGTPCLangevinEngine: Problem 2 in point logic";
+            break;
+        }
+        if (readyToProject != kTRUE)
+        { // track somehow exited the gas volume or
+          // dissappeared in a previous point :‑O
+            LOG(fatal) << "R3BGTPCLangevinEngine: Problem 3 in point logic";
+            break;
+        }
+        if (aPoint->GetTrackStatus() == 10100 || aPoint->GetTrackStatus() == 1000000)
+        { // exiting the gas volume or dissappearing
+            readyToProject = kFALSE;
+        }
+
+        DriftSegment segment;
+        segment.xPre = xPre;
+        segment.yPre = yPre;
+        segment.zPre = zPre;
+        // again from gMC->TrackPosition() for next point position
+        segment.xPost = aPoint->GetX();
+        segment.yPost = aPoint->GetY();
+        segment.zPost = aPoint->GetZ();
+        segment.timeBeforeDrift = aPoint->GetTime(); // ns
+        electrons = aPoint->GetEnergyLoss() / fPar.fEIonization;
+        // electron number fluctuates as the square root of
+        // the Fano factor times the number of electrons
+        flucElectrons = pow(fPar.fFanoFactor * electrons, 0.5);
+        segment.generatedElectrons = fanoRnd.Gaus(electrons, flucElectrons); // generated electrons
+        segment.electronsPerBunch =
+            BunchSize(fPar.fElectronsPerBunch, segment.generatedElectrons, fPar.fMaxCarriersPerPoint);
+        segment.point = i;
+        segment.evtID = aPoint->GetEventID();
+        segment.PDGCode = PDGCode;
+        segment.MotherId = MotherId;
+        segment.Vertex_x0 = Vertex_x0;
+        segment.Vertex_y0 = Vertex_y0;
+        segment.Vertex_z0 = Vertex_z0;
+        segment.Vertex_px0 = Vertex_px0;
+        segment.Vertex_py0 = Vertex_py0;
+        segment.Vertex_pz0 = Vertex_pz0;
+        segments.push_back(segment);
+
+        xPre = segment.xPost;
+        yPre = segment.yPost;
+        zPre = segment.zPost;
+    }
+}
+
+void R3BGTPCLangevinEngine::Digitize(const TClonesArray& points,
+                                     const TClonesArray& mcTracks,
+                                     ULong64_t runSeed,
+                                     Workspace& ws,
+                                     TClonesArray* calData,
+                                     TClonesArray* projPoints) const
+{
+    ws.accumulator.Reset();
+    if (points.GetEntries() == 0)
+        return;
+    UInt_t eventID = ((R3BGTPCPoint*)points.At(0))->GetEventID();
+
+    // First pass, sequential: follow the point logic of each track and collect
+    // the track portions ionizing the gas together with their number of electrons
+    R3BGTPCRandom fanoRnd(runSeed, eventID, R3BGTPCRandom::kEventStream);
+    MakeSegments(points, mcTracks, fanoRnd, ws);
+    auto& segments = ws.segments;
+    Int_t nSegments = segments.size();
+
+    // Event budget: the carriers of every segment are scaled down by the same
+    // factor, so the charge keeps its distribution among the segments. Each
+    // segment keeps at least one carrier, so the budget can be exceeded by up
+    // to one carrier per segment
+    Long64_t totalCarriers = 0;
+    for (const auto& segment : segments)
+        totalCarriers += Carriers(segment);
+    if (fPar.fMaxCarriersPerEvent > 0 && totalCarriers > fPar.fMaxCarriersPerEvent)
+    {
+        Double_t scale = (Double_t)fPar.fMaxCarriersPerEvent / totalCarriers;
+        LOG(debug) << "R3BGTPCLangevinEngine: " << totalCarriers << " carriers over the budget of "
+                   << fPar.fMaxCarriersPerEvent << ", bunching them by " << 1. / scale;
+        totalCarriers = 0;
+        for (auto& segment : segments)
+        {
+            Long64_t maxCarriers = std::max<Long64_t>(1, scale * Carriers(segment));
+            segment.electronsPerBunch = std::max(
+                segment.electronsPerBunch, BunchSize(fPar.fElectronsPerBunch, segment.generatedElectrons, maxCarriers));
+            totalCarriers += Carriers(segment);
+        }
+    }
+
+    // Second pass, parallel: the segments are split in contiguous ranges with
+    // a similar number of carriers, one per thread. Each segment is drifted
+    // with the stream of its point, so the result does not depend on the
+    // number of threads. Each thread finds the pads of its arrivals and adds
+    // them to its own accumulator (the first thread to the one of the
+    // workspace), or keeps them for the R3BGTPCProjPoint output. The threads
+    // other than the calling one are started with the first event and reused
+    Int_t maxThreads = fPar.fNumberOfThreads > 0 ? fPar.fNumberOfThreads : std::thread::hardware_concurrency();
+    maxThreads = std::max(1, maxThreads);
+    if (maxThreads > 1 && !ws.pool)
+        ws.pool = std::make_unique<R3BGTPCThreadPool>(maxThreads - 1);
+    Int_t nThreads = std::max(1, std::min(maxThreads, nSegments));
+
+    std::vector<Int_t> firstSegment(nThreads + 1, nSegments);
+    firstSegment[0] = 0;
+    Long64_t accCarriers = 0;
+    Int_t thread = 1;
+    for (Int_t s = 0; s < nSegments && thread < nThreads; s++)
+    {
+        accCarriers += Carriers(segments[s]);
+        if (accCarriers * nThreads >= totalCarriers * thread)
+            firstSegment[thread++] = s + 1;
+    }
+
+    auto& arrivals = ws.arrivals;
+    if ((Int_t)arrivals.size() < nThreads)
+        arrivals.resize(nThreads);
+    for (auto& threadArrivals : arrivals)
+        threadArrivals.clear();
+    auto& accumulators = ws.accumulators;
+    while ((Int_t)accumulators.size() < nThreads - 1)
+        accumulators.emplace_back(ws.accumulator.GetNPads(), ws.accumulator.GetNTimeBins());
+    ws.offPad.assign(nThreads, 0);
+    auto driftRange = [&](Int_t t)
+    {
+        R3BGTPCRandom rnd;
+        auto& threadArrivals = arrivals[t];
+        auto& accumulator = t == 0 ? ws.accumulator : accumulators[t - 1];
+        accumulator.Reset();
+        for (Int_t s = firstSegment[t]; s < firstSegment[t + 1]; s++)
+        {
+            rnd.SetSeed(runSeed, eventID, segments[s].point);
+            size_t first = threadArrivals.size();
+            DriftElectrons(segments[s], s, rnd, threadArrivals);
+            for (size_t a = first; a < threadArrivals.size(); a++)
+            {
+                threadArrivals[a].pad = GetPad(threadArrivals[a]);
+                if (threadArrivals[a].pad < 0)
+                    ws.offPad[t]++;
+            }
+            if (calData)
+            {
+                for (const auto& arrival : threadArrivals)
+                    Accumulate(arrival, accumulator);
+                threadArrivals.clear();
+            }
+        }
+    };
+    if (nThreads == 1)
+        driftRange(0);
+    else
+        ws.pool->Run(nThreads, driftRange);
+
+    // If returns negative padID means it is out of the pad plane
+    // Maybe error in the pad plane limits in DriftElectrons
+    Long64_t offPad = 0;
+    for (auto n : ws.offPad)
+        offPad += n;
+    if (offPad > 0)
+        LOG(warn) << "R3BGTPCLangevinEngine: No-valid padID for " << offPad << " arrivals";
+
+    // Merge, sequential: the threads are taken in the order of their
+    // segments, so the pads are touched in the same order as by one thread
+    if (calData)
+    {
+        for (Int_t t = 1; t < nThreads; t++)
+            ws.accumulator.Add(accumulators[t - 1]);
+        FillCalData(ws.accumulator, *calData);
+    }
+    else if (projPoints)
+    {
+        for (const auto& threadArrivals : arrivals)
+            for (const auto& arrival : threadArrivals)
+                AddProjPoint(arrival, segments[arrival.segment], ws.accumulator, *projPoints);
+    }
+}
+
+void R3BGTPCLangevinEngine::DriftElectrons(const DriftSegment& segment,
+                                           Int_t index,
+                                           R3BGTPCRandom& rnd,
+                                           std::vector<DriftArrival>& arrivals) const
+{
+    const R3BGTPCDriftParameters& drift = fPar.fDrift;
+    Int_t generatedElectrons = segment.generatedElectrons;
+
+    // step in each direction for an homogeneous electron creation position
+    // along the track
+    Double_t stepX = (segment.xPost - segment.xPre) / generatedElectrons;
+    Double_t stepY = (segment.yPost - segment.yPre) / generatedElectrons;
+    Double_t stepZ = (segment.zPost - segment.zPre) / generatedElectrons;
+
+    Double_t ele_x = 0;
+    Double_t ele_y = 0;
+    Double_t ele_z = 0;
+    Double_t accDriftTime = 0;
+
+    // FINAL RESULT: X,Z position and time of the electron after Langevin
+    // calculation. Removing electrons out of pad plane limits
+    auto addArrival = [&](Double_t projX, Double_t projZ, Double_t projTime, Int_t weight)
+    {
+        if (projZ < drift.fOffsetZ || projZ > drift.fOffsetZ + 2 * drift.fHalfSizeTPC_Z || projX < drift.fOffsetX ||
+            projX > drift.fOffsetX + 2 * drift.fHalfSizeTPC_X)
+            return;
+        arrivals.push_back({ projX, projZ, projTime, weight, index, -1 });
+    };
+
+    // Electrons not covered by the drift map are collected and stepped together
+    R3BGTPCDriftStepper::Electrons electrons;
+    std::vector<Int_t> weights;
+
+    Int_t electronsPerBunch = segment.electronsPerBunch;
+    for (Int_t ele = 1; ele <= generatedElectrons; ele += electronsPerBunch)
+    {
+        // For a single electron, or a bunch of them drifting as one carrier
+        // placed uniformly in the part of the step of its electrons, so the
+        // charge keeps its spread along the step (the last bunch can be partial)
+        Int_t bunchWeight = std::min(electronsPerBunch, generatedElectrons - ele + 1);
+        Double_t eleStart = ele;
+        if (bunchWeight > 1)
+            eleStart = ele - 1 + bunchWeight * rnd.Rndm();
+        ele_x = segment.xPre + stepX * eleStart; // homogeneous electron creation along the step [cm]
+        ele_y = segment.yPre + stepY * eleStart;
+        ele_z = segment.zPre + stepZ * eleStart;
+        accDriftTime = segment.timeBeforeDrift;
+
+        if (fDriftMap && fDriftMap->IsInside(ele_x, ele_y, ele_z))
+        { // mean transport from the map, one smearing for the whole drift
+            Double_t transfer[R3BGTPCDriftMap::kNQuantities];
+            fDriftMap->GetTransfer(ele_x, ele_y, ele_z, transfer);
+            ele_x = rnd.Gaus(transfer[R3BGTPCDriftMap::kX], transfer[R3BGTPCDriftMap::kSigmaTransv]);
+            ele_z = rnd.Gaus(transfer[R3BGTPCDriftMap::kZ], transfer[R3BGTPCDriftMap::kSigmaTransv]);
+            accDriftTime = rnd.Gaus(accDriftTime + transfer[R3BGTPCDriftMap::kTime],
+                                    transfer[R3BGTPCDriftMap::kSigmaTime]);
+            addArrival(ele_x, ele_z, accDriftTime, bunchWeight);
+        }
+        else
+        {
+            electrons.Add(ele_x, ele_y, ele_z, accDriftTime, ele);
+            weights.push_back(bunchWeight);
+        }
+    }
+
+    // TODO!!! CHECK THE NEGATIVE sign in the y directions of the stepper...
+    // Could it be symmetric with the others (+) in case the electric field is
+    // negative in Y? Does it change other cross terms? Which one is correct?
+    fStepper->DriftForward(electrons, rnd);
+    for (Int_t e = 0; e < electrons.GetSize(); e++)
+        addArrival(electrons.x[e], electrons.z[e], electrons.t[e], weights[e]);
+}
+
+Int_t R3BGTPCLangevinEngine::GetPad(const DriftArrival& arrival) const
+{
+    Int_t padID = fPadPlane->GetPadIndex((arrival.z - fPar.fDrift.fOffsetZ) * 10.0,
+                                         (arrival.x - fPar.fDrift.fOffsetX) * 10.0); // in mm for the padID
+
+    return fPadPlane->IsValid(padID) ? padID : -1;
+}
+
+void R3BGTPCLangevinEngine::Accumulate(const DriftArrival& arrival, R3BGTPCPadAccumulator& accumulator) const
+{
+    if (arrival.pad < 0)
+        return;
+
+    // Output: R3BGTPCCalData, created from the accumulator at the end of Digitize
+    Double_t projTime = arrival.time / fPar.fTimeBinSize; // moving from ns to binsize
+    if (projTime < 0)
+        projTime = 0; // Fills (first) underflow bin
+    else if (projTime > fPar.fNTimeBins - 1)
+        projTime = fPar.fNTimeBins - 1; // Fills (last) overflow bin
+    accumulator.Add(arrival.pad, projTime, arrival.weight);
+}
+
+void R3BGTPCLangevinEngine::AddProjPoint(const DriftArrival& arrival,
+                                         const DriftSegment& segment,
+                                         R3BGTPCPadAccumulator& accumulator,
+                                         TClonesArray& projPoints) const
+{
+    if (arrival.pad < 0)
+        return;
+
+    // Output: TClonesArray of R3BGTPCProjPoint, with the same index as the pad row
+    Double_t projTime = arrival.time;
+    Int_t padID = arrival.pad;
+    Int_t row = accumulator.GetRow(padID);
+    if (row >= 0)
+    {
+        // already existing R3BGTPCProjPoint... add time and electron
+        ((R3BGTPCProjPoint*)projPoints.At(row))->AddCharge(arrival.weight);
+        ((R3BGTPCProjPoint*)projPoints.At(row))
+            ->SetTimeDistr(projTime / fPar.fTimeBinSize, arrival.weight); // micros
+    }
+    else
+    {
+        row = accumulator.Touch(padID);
+        new (projPoints[row]) R3BGTPCProjPoint(padID,
+                                               projTime / fPar.fTimeBinSize, // micros
+                                               arrival.weight,
+                                               segment.evtID,
+                                               segment.PDGCode,
+                                               segment.MotherId,
+                                               segment.Vertex_x0,
+                                               segment.Vertex_y0,
+                                               segment.Vertex_z0,
+                                               segment.Vertex_px0,
+                                               segment.Vertex_py0,
+                                               segment.Vertex_pz0);
+    }
+}
+
+void R3BGTPCLangevinEngine::FillCalData(const R3BGTPCPadAccumulator& accumulator, TClonesArray& calData) const
+{
+    const auto& pads = accumulator.GetTouchedPads();
+    Int_t nTimeBins = accumulator.GetNTimeBins();
+    std::vector<UShort_t> adc(nTimeBins);
+    for (size_t row = 0; row < pads.size(); row++)
+    {
+        const Double_t* counts = accumulator.GetTimeBins(row);
+        for (Int_t bin = 0; bin < nTimeBins; bin++)
+            adc[bin] = std::min<Double_t>(counts[bin], kMaxUShort);
+        new (calData[row]) R3BGTPCCalData(pads[row], adc, fPar.fZeroSuppress);
+    }
+}
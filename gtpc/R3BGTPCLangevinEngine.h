@@ -0,0 +1,180 @@
+/******************************************************************************
+ *   Copyright (C) 2018 GSI Helmholtzzentrum für Schwerionenforschung GmbH    *
+ *   Copyright (C) 2018-2025 Members of R3B Collaboration                     *
+ *                                                                            *
+ *             This software is distributed under the terms of the            *
+ *                 GNU Lesser General Public Licence (LGPL) version 3,        *
+ *                    copied verbatim in the file "LICENSE".                  *
+ *                                                                            *
+ * In applying this license GSI does not waive the privileges and immunities  *
+ * granted to it by virtue of its status as an Intergovernmental Organization *
+ * or submit itself to any jurisdiction.                                      *
+ ******************************************************************************/
+
+/**  R3BGTPCLangevinEngine.h
+ * Digitization kernel of R3BGTPCLangevin: from the GTPCPoints of an event to
+ * the charge on the pad plane, without any state of its own between events
+ **/
+
+#pragma once
+
+#include "R3BGTPCDriftMap.h"
+#include "R3BGTPCDriftParameters.h"
+#include "R3BGTPCDriftStepper.h"
+#include "R3BGTPCFieldCache.h"
+#include "R3BGTPCPadAccumulator.h"
+#include "R3BGTPCPadGeometry.h"
+#include "R3BGTPCRandom.h"
+#include "R3BGTPCThreadPool.h"
+#include "Rtypes.h"
+
+#include <memory>
+#include <vector>
+
+class TClonesArray;
+
+/**
+ * GTPC Langevin digitization engine
+ *
+ * The engine holds the parameters by value and the read-only field cache,
+ * stepper, drift map and pad plane through shared pointers, and all its
+ * methods are const: one engine (or several engines sharing the same field
+ * cache) can digitize independent events in as many threads as wanted. What
+ * changes from event to event lives in a Workspace, one per event stream,
+ * which keeps its memory between the events of the stream.
+ *
+ * The random numbers of an event only depend on the run seed and the event
+ * ID of its points, see Digitize.
+ */
+
+class R3BGTPCLangevinEngine
+{
+  public:
+    /** Values of the parameter containers and task settings used per event **/
+    struct Parameters
+    {
+        R3BGTPCDriftParameters fDrift;     //!< Drift parameters, also placing the pad plane
+        Double_t fEIonization = 0.;        //!< Effective ionization energy of gas [GeV]
+        Double_t fFanoFactor = 0.;         //!< Fano factor of the electron number fluctuations
+        Double_t fTimeBinSize = 0.;        //!< Time size of each bin of R3BGTPCCalData [ns]
+        Int_t fNTimeBins = 512;            //!< Time bins of R3BGTPCCalData
+        Int_t fElectronsPerBunch = 1;      //!< Electrons drifted together as one carrier
+        Int_t fMaxCarriersPerPoint = 0;    //!< Carriers drifted per point at most, 0 no cap
+        Long64_t fMaxCarriersPerEvent = 0; //!< Carriers drifted per event, about, 0 no budget
+        Int_t fNumberOfThreads = 1;        //!< Threads drifting the electrons of an event, 0 all cores
+        Bool_t fZeroSuppress = kTRUE;      //!< Zero suppressed R3BGTPCCalData
+    };
+
+    /** Track portion between two GTPCPoints and the electrons it ionizes **/
+    struct DriftSegment
+    {
+        Double_t xPre, yPre, zPre;
+        Double_t xPost, yPost, zPost;
+        Double_t timeBeforeDrift; //!< [ns]
+        Int_t generatedElectrons;
+        Int_t electronsPerBunch; //!< Electrons of each carrier
+        Int_t point;             //!< Index of the GTPCPoint ending the segment
+        Int_t evtID;
+        Int_t PDGCode, MotherId;
+        Double_t Vertex_x0, Vertex_y0, Vertex_z0, Vertex_px0, Vertex_py0, Vertex_pz0;
+    };
+
+    /** Electron (or bunch) reaching the pad plane **/
+    struct DriftArrival
+    {
+        Double_t x, z; //!< Position on the pad plane [cm]
+        Double_t time; //!< Arrival time [ns]
+        Int_t weight;  //!< Number of electrons
+        Int_t segment; //!< Index of the DriftSegment it comes from
+        Int_t pad;     //!< Pad reached, -1 if none
+    };
+
+    /** Memory of an event stream, reused from one event to the next **/
+    struct Workspace
+    {
+        Workspace(Int_t nPads, Int_t nTimeBins)
+            : accumulator(nPads, nTimeBins)
+        {
+        }
+
+        R3BGTPCPadAccumulator accumulator;               //!< Electrons per pad and time bin
+        std::vector<R3BGTPCPadAccumulator> accumulators; //!< Electrons per pad and time bin, per thread but the first
+        std::vector<DriftSegment> segments;              //!< Segments of the event
+        std::vector<std::vector<DriftArrival>> arrivals; //!< Arrivals at the pad plane, per thread
+        std::vector<Long64_t> offPad;                    //!< Arrivals on no valid pad, per thread
+        std::unique_ptr<R3BGTPCThreadPool> pool;         //!< Drift threads but the calling one, started at first use
+    };
+
+    /** Constructor
+     *@param par        Parameters, copied
+     *@param padPlane   Pad plane geometry
+     *@param field      Field cache the stepper (and drift map) were built on
+     *@param stepper    Langevin stepper of the drift
+     *@param driftMap   Drift transfer map, nullptr to always step
+     **/
+    R3BGTPCLangevinEngine(const Parameters& par,
+                          std::shared_ptr<const R3BGTPCPadGeometry> padPlane,
+                          std::shared_ptr<const R3BGTPCFieldCache> field,
+                          std::shared_ptr<const R3BGTPCDriftStepper> stepper,
+                          std::shared_ptr<const R3BGTPCDriftMap> driftMap = nullptr);
+
+    /** Destructor **/
+    ~R3BGTPCLangevinEngine() = default;
+
+    /** New workspace for an event stream **/
+    std::unique_ptr<Workspace> MakeWorkspace() const;
+
+    /** Digitize the R3BGTPCPoints of an event into calData (R3BGTPCCalData)
+     ** or, if it is nullptr, into projPoints (R3BGTPCProjPoint). The output
+     ** array must be empty. The random streams are keyed by runSeed and the
+     ** event ID of the points: the Fano fluctuations are taken from the
+     ** R3BGTPCRandom::kEventStream and the drift of the electrons of point i
+     ** from the stream i **/
+    void Digitize(const TClonesArray& points,
+                  const TClonesArray& mcTracks,
+                  ULong64_t runSeed,
+                  Workspace& ws,
+                  TClonesArray* calData,
+                  TClonesArray* projPoints) const;
+
+    const Parameters& GetParameters() const { return fPar; }
+    const R3BGTPCPadGeometry& GetPadPlane() const { return *fPadPlane; }
+    const R3BGTPCDriftStepper& GetStepper() const { return *fStepper; }
+
+  private:
+    const Parameters fPar;                               //!< Parameters
+    std::shared_ptr<const R3BGTPCPadGeometry> fPadPlane; //!< Pad plane geometry
+    std::shared_ptr<const R3BGTPCFieldCache> fField;     //!< GLAD field, kept alive for the stepper
+    std::shared_ptr<const R3BGTPCDriftStepper> fStepper; //!< Langevin stepper for electron packets
+    std::shared_ptr<const R3BGTPCDriftMap> fDriftMap;    //!< Drift transfer map, if in lookup mode
+
+    /** Fill ws.segments from the point logic of each track **/
+    void MakeSegments(const TClonesArray& points,
+                      const TClonesArray& mcTracks,
+                      R3BGTPCRandom& fanoRnd,
+                      Workspace& ws) const;
+
+    /** Drift the electrons of a segment, thread safe as long as each call has
+     ** its own rnd and arrivals **/
+    void DriftElectrons(const DriftSegment& segment,
+                        Int_t index,
+                        R3BGTPCRandom& rnd,
+                        std::vector<DriftArrival>& arrivals) const;
+
+    /** Pad plane lookup, -1 if the arrival is not on a valid pad. Does not
+     ** log, as it runs on the drift threads **/
+    Int_t GetPad(const DriftArrival& arrival) const;
+
+    /** Add an arrival on a valid pad to the time bins of the accumulator **/
+    void Accumulate(const DriftArrival& arrival, R3BGTPCPadAccumulator& accumulator) const;
+
+    /** Add an arrival on a valid pad to its R3BGTPCProjPoint in projPoints,
+     ** the accumulator giving the row of each pad **/
+    void AddProjPoint(const DriftArrival& arrival,
+                      const DriftSegment& segment,
+                      R3BGTPCPadAccumulator& accumulator,
+                      TClonesArray& projPoints) const;
+
+    /** Creation of the R3BGTPCCalData of the touched pads from the accumulator **/
+    void FillCalData(const R3BGTPCPadAccumulator& accumulator, TClonesArray& calData) const;
+};
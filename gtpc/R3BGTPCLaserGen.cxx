@@ -12,11 +12,11 @@
  ********************************************************************************/
 
 #include "R3BGTPCLaserGen.h"
+#include "R3BGTPCRandom.h"
 #include "R3BMCTrack.h"
 
 #include "TClonesArray.h"
 #include "TMath.h"
-#include "TRandom3.h"
 #include "TVirtualMC.h"
 #include "TVirtualMCStack.h"
 
@@ -49,7 +49,9 @@ R3BGTPCLaserGen::R3BGTPCLaserGen()
     fOffsetX = 0.; // cm
     fOffsetZ = 0.; // cm
     outputMode = 0;
-    fTPCMap = std::make_shared<R3BGTPCMap>();
+    fIntegrator = R3BGTPCDriftStepper::kEuler;
+    fIntegratorTolerance = 1e-4;
+    fRunSeed = 0;
 }
 
 R3BGTPCLaserGen::~R3BGTPCLaserGen()
@@ -172,17 +174,21 @@ InitStatus R3BGTPCLaserGen::Init()
     }
 
     SetParameter();
+    fRunSeed = R3BGTPCRandom::MakeRunSeed(fRunSeed);
+    LOG(info) << "R3BGTPCLaserGen::Init: Random seed of the run " << fRunSeed;
 
-    fTPCMap->GeneratePadPlane();
-    fPadPlane = fTPCMap->GetPadPlane();
-
-    if (fPadPlane == NULL)
+    // Field cache shared with the other GTPC drift tasks
+    fFieldCache = R3BGTPCFieldCache::Instance(fGTPCGeoPar, R3BGTPCFieldCache::GetRunField());
+    if (!fFieldCache)
     {
-        std::cout << " R3BGTPCProjector::Init() error! - Could not retrieve pad "
-                     "plane. Exiting..."
-                  << endl;
-        return kERROR;
+        LOG(fatal) << "R3BGTPCLaserGen::Init: No GLAD field map";
+        return kFATAL;
     }
+    fStepper = std::make_unique<R3BGTPCDriftStepper>(fFieldCache.get(), GetDriftParameters());
+    fStepper->SetIntegrator(fIntegrator, fIntegratorTolerance);
+
+    // Pad plane geometry
+    fPadGeometry = R3BGTPCPadGeometry::Instance(fGTPCGeoPar);
 
     return kSUCCESS;
 }
@@ -191,9 +197,30 @@ InitStatus R3BGTPCLaserGen::ReInit()
 {
     SetParContainers();
     SetParameter();
+    fFieldCache = R3BGTPCFieldCache::Instance(fGTPCGeoPar, R3BGTPCFieldCache::GetRunField());
+    if (!fFieldCache)
+        return kFATAL;
+    fStepper = std::make_unique<R3BGTPCDriftStepper>(fFieldCache.get(), GetDriftParameters());
+    fStepper->SetIntegrator(fIntegrator, fIntegratorTolerance);
     return kSUCCESS;
 }
 
+R3BGTPCDriftParameters R3BGTPCLaserGen::GetDriftParameters() const
+{
+    R3BGTPCDriftParameters par;
+    par.fDriftVelocity = fDriftVelocity;
+    par.fTransDiff = fTransDiff;
+    par.fLongDiff = fLongDiff;
+    par.fDriftEField = fDriftEField;
+    par.fDriftTimeStep = fDriftTimeStep;
+    par.fHalfSizeTPC_X = fHalfSizeTPC_X;
+    par.fHalfSizeTPC_Y = fHalfSizeTPC_Y;
+    par.fHalfSizeTPC_Z = fHalfSizeTPC_Z;
+    par.fOffsetX = fOffsetX;
+    par.fOffsetZ = fOffsetZ;
+    return par;
+}
+
 void R3BGTPCLaserGen::SetDriftParameters(Double_t ion,
                                          Double_t driftv,
                                          Double_t tDiff,
@@ -246,9 +273,6 @@ void R3BGTPCLaserGen::Exec(Option_t*)
     Double_t projX, projZ, projTime;
     Double_t timeBeforeDrift = 0.;
     Bool_t padFound = kFALSE;
-    Double_t driftDistance;
-    Double_t sigmaLongAtPadPlane;
-    Double_t sigmaTransvAtPadPlane;
     Int_t evtID = 0;
     Int_t PDGCode = 0, MotherId = 0;
     Double_t Vertex_x0 = 0, Vertex_y0 = 0, Vertex_z0 = 0, Vertex_px0 = 0, Vertex_py0 = 0, Vertex_pz0 = 0;
@@ -268,31 +292,15 @@ void R3BGTPCLaserGen::Exec(Option_t*)
         Vertex_pz0 = Track->GetPz();
     }
 
-    // Using here m, V, T, s just to simplify in SI system...
-    Double_t E_x = 0;
-    Double_t E_z = 0;
-    Double_t E_y = fDriftEField * 100;
     Double_t B_x = 0.;
     Double_t B_y = 0.;
     Double_t B_z = 0.;
-    Double_t moduleB = 0;
     Double_t ele_x_init = 0;
     Double_t ele_y_init = 0;
     Double_t ele_z_init = 0;
     Double_t ele_x = 0;
-    Double_t ele_y = 0;
     Double_t ele_z = 0;
-    Double_t vDrift_x = 0;
-    Double_t vDrift_y = 0;
-    Double_t vDrift_z = 0;
-    Double_t accDriftTime = 0;
-    Double_t cteMult = 0;
-    Double_t cteMod = 0;
-    Double_t productEB = 0;
-    Double_t sigmaLongStep;
-    Double_t sigmaTransvStep;
-    Double_t driftTimeStep;
-    Double_t mu = 1.E+7 * fDriftVelocity / E_y; // [m2 s-1 V-1] TODO check value, move to parameter container
+    R3BGTPCDriftStepper::Electrons electrons;
 
     // from create_tpc_geo_test.C (geo in file
     // R3BRoot/glad-tpc/geometry/gladTPC_test.geo.root)
@@ -371,10 +379,13 @@ void R3BGTPCLaserGen::Exec(Option_t*)
     Double_t rads[3] = { rX, rY, rZ };
     Double_t rMin = TMath::MinElement(3, rads);
 
-    TRandom3 rndGen;
+    // the position on the laser line and the drift of the electrons of point k
+    // use the stream k of the event
+    R3BGTPCRandom rnd;
     for (Int_t k = 0; k < fMaxLength; k++)
     {
-        Double_t r = rndGen.Uniform(0, rMin);
+        rnd.SetSeed(fRunSeed, evtID, k);
+        Double_t r = rMin * rnd.Rndm();
 
         // Parametrize the straight line with beta and alpha angles
         Double_t xval = r * cos(fBeta) * sin(fAlpha);
@@ -385,72 +396,20 @@ void R3BGTPCLaserGen::Exec(Option_t*)
         ele_x_init = cos(-TargetAngle) * (xval) + sin(-TargetAngle) * (zval);
         ele_z_init = TargetOffsetZ_FM - fHalfSizeTPC_Z - sin(-TargetAngle) * (xval) + cos(-TargetAngle) * (zval);
 
-        // taken the driftDistance for the calculation of the sigmaLong and
-        // sigmaTrans
-        driftDistance = ele_y + fHalfSizeTPC_Y;
-        sigmaLongAtPadPlane = sqrt(driftDistance * 2 * fLongDiff / fDriftVelocity);
-        sigmaTransvAtPadPlane = sqrt(driftDistance * 2 * fTransDiff / fDriftVelocity);
-
+        // Drifting all the electrons of the point together, with the Langevin
+        // stepper shared with R3BGTPCLangevin (units [cm], [ns], [V/cm])
+        electrons.Clear();
         for (Int_t ele = 0; ele < fNumberOfGeneratedElectrons; ele++)
-        {
-            ele_x = ele_x_init;
-            ele_y = ele_y_init;
-            ele_z = ele_z_init;
-
-            accDriftTime = timeBeforeDrift;
-            driftTimeStep = fDriftTimeStep;
-            LOG(debug) << "R3BGTPCLaserGen::Exec, INITIAL VALUES: timeBeforeDrift=" << accDriftTime << " [ns]"
-                       << " ele_x=" << ele_x << " ele_y=" << ele_y << " ele_z=" << ele_z << " [cm]";
-
-            while (ele_y > -fHalfSizeTPC_Y) // while not reaching the pad plane [cm]
-            {
+            electrons.Add(ele_x_init, ele_y_init, ele_z_init, timeBeforeDrift);
+        LOG(debug) << "R3BGTPCLaserGen::Exec, INITIAL VALUES: timeBeforeDrift=" << timeBeforeDrift << " [ns]"
+                   << " ele_x=" << ele_x_init << " ele_y=" << ele_y_init << " ele_z=" << ele_z_init << " [cm]";
+        fStepper->DriftForward(electrons, rnd);
 
-                B_x = 0.1 * gladField->GetBx(ele_x, ele_y,
-                                             ele_z); // Field components return in [kG], moved to [T]
-                B_y = 0.1 * gladField->GetBy(ele_x, ele_y, ele_z);
-                B_z = 0.1 * gladField->GetBz(ele_x, ele_y, ele_z);
-
-                moduleB = TMath::Sqrt(B_x * B_x + B_y * B_y + B_z * B_z); // in [T]
-                cteMod = 1 / (1 + mu * mu * moduleB * moduleB);           // SI
-                cteMult = mu * cteMod;                                    // SI
-
-                // assuming only vertical electric field in the next four lines
-                productEB = E_y * B_y; // E_x*B_x + E_y*B_y + E_z*B_z; SI
-
-                vDrift_x = cteMult * (mu * (E_y * B_z) + mu * mu * productEB * B_x); // cte * (Ex + mu*(E_y*B_z-E_z*B_y)
-                                                                                     // + mu*mu*productEB*B_x); SI
-                vDrift_y = cteMult * (E_y + mu * mu * productEB * B_y); // cte * (Ey + mu*(E_z*B_x-E_x*B_z) +
-                                                                        // mu*mu*productEB*B_y); SI
-                vDrift_z =
-                    cteMult * (mu * (-E_y * B_x) + mu * mu * productEB * B_z); // cte * (Ez + mu*(E_x*B_y-E_y*B_x) +
-                                                                               // mu*mu*productEB*B_z); SI
-
-                LOG(debug) << "R3BGTPCLaserGen::Exec, timeBeforeDrift=vDrift_x=" << vDrift_x << " vDrift_y=" << vDrift_y
-                           << " vDrift_z=" << vDrift_z << " [m/s]";
-
-                // adjusting the last step before the pad plane
-                if (ele_y - 1.E-7 * vDrift_y * driftTimeStep < -fHalfSizeTPC_Y)
-                    driftTimeStep = (ele_y + fHalfSizeTPC_Y) / (1.E-7 * vDrift_y); // vDrift back to [cm/ns]
-
-                // reducing sigmaTransv (see
-                // http://web.ift.uib.no/~lipniack/detectors/lecture5/detector5.pdf) as
-                // B~B_y and E=E_y, let's simplify and apply the reduction to the
-                // transversal coefficient without projections
-                sigmaTransvStep =
-                    sqrt(driftTimeStep * 2 * fTransDiff * cteMod); // should be reduced by the factor cteMod=cteMult/mu
-                sigmaLongStep =
-                    sqrt(driftTimeStep * 2 * fLongDiff); // should be the same scaled to the length of the step
-                ele_x = gRandom->Gaus(ele_x + 1.E-7 * vDrift_x * driftTimeStep,
-                                      sigmaTransvStep); // vDrift back to [cm/ns]
-                ele_y = gRandom->Gaus(ele_y - 1.E-7 * vDrift_y * driftTimeStep, sigmaLongStep);
-                ele_z = gRandom->Gaus(ele_z + 1.E-7 * vDrift_z * driftTimeStep, sigmaTransvStep);
-                accDriftTime = accDriftTime + driftTimeStep;
-
-                LOG(debug) << "R3BGTPCLaserGen::Exec, accDriftTime=" << accDriftTime << " [ns]"
-                           << " ele_x=" << ele_x << " ele_y=" << ele_y << " ele_z=" << ele_z << " [cm]";
-            }
-
-            projTime = accDriftTime;
+        for (Int_t ele = 0; ele < electrons.GetSize(); ele++)
+        {
+            ele_x = electrons.x[ele];
+            ele_z = electrons.z[ele];
+            projTime = electrons.t[ele];
 
             // obtain padID for projX, projZ (simple algorithm)
             // 1) Fill an histogram with histoBins (X-axis) and histoBins1 (Y-axis)
@@ -466,14 +425,12 @@ void R3BGTPCLaserGen::Exec(Option_t*)
                 projX > fOffsetX + 2 * fHalfSizeTPC_X)
                 continue;
 
-            // Adding -1 to get padID between 0 - 5631
-            Int_t padID = fPadPlane->Fill((projZ - fOffsetZ) * 10.0,
-                                          (projX - fOffsetX) * 10.0) -
-                          1; // in mm for the padID
+            Int_t padID = fPadGeometry->GetPadIndex((projZ - fOffsetZ) * 10.0,
+                                                    (projX - fOffsetX) * 10.0); // in mm for the padID
 
-            // If returns negative padID means its filling overflow/underflow bins
+            // If returns negative padID means it is out of the pad plane
             // Maybe error in the conditionals projX and projZ above
-            if (padID < 0 || padID > 5631)
+            if (!fPadGeometry->IsValid(padID))
             {
                 LOG(warn) << "R3BGTPCLangevin::Exec No-valid padID" << endl;
                 continue;
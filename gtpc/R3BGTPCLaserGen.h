@@ -20,10 +20,12 @@
 
 #include "FairTask.h"
 #include "R3BGTPCCalData.h"
+#include "R3BGTPCDriftStepper.h"
 #include "R3BGTPCElecPar.h"
+#include "R3BGTPCFieldCache.h"
 #include "R3BGTPCGasPar.h"
 #include "R3BGTPCGeoPar.h"
-#include "R3BGTPCMap.h"
+#include "R3BGTPCPadGeometry.h"
 #include "R3BGTPCPoint.h"
 #include "R3BGTPCProjPoint.h"
 #include "TClonesArray.h"
@@ -62,6 +64,18 @@ class R3BGTPCLaserGen : public FairTask
     void SetProjPointsAsOutput() { outputMode = 1; }
     void SetCalDataAsOutput() { outputMode = 0; }
 
+    /** Integrator of the drift. With R3BGTPCDriftStepper::kRK45 the drift time
+     ** step is the largest step and tolerance the position error per step [cm] **/
+    void SetDriftIntegrator(R3BGTPCDriftStepper::EIntegrator integrator, Double_t tolerance = 1e-4)
+    {
+        fIntegrator = integrator;
+        fIntegratorTolerance = tolerance;
+    }
+
+    /** Seed of the random streams of the run, keyed then by event ID and laser
+     ** point (see R3BGTPCRandom). Default 0: drawn from gRandom in Init **/
+    void SetRunSeed(ULong64_t seed) { fRunSeed = seed; }
+
   protected:
     /** Virtual method Init **/
     virtual InitStatus Init();
@@ -116,13 +130,19 @@ class R3BGTPCLaserGen : public FairTask
 
     Int_t fNumberOfGeneratedElectrons; //!< Number of electrons to generate in
                                        //!< each point of the test
+    ULong64_t fRunSeed;                //!< Seed of the random streams of the run
 
     R3BGTPCGeoPar* fGTPCGeoPar;   //!< Geometry parameter container
     R3BGTPCGasPar* fGTPCGasPar;   //!< Gas parameter container
     R3BGTPCElecPar* fGTPCElecPar; //!< Electronic parameter container
 
-    std::shared_ptr<R3BGTPCMap> fTPCMap;
-    TH2Poly* fPadPlane;
+    std::shared_ptr<const R3BGTPCPadGeometry> fPadGeometry; //!< Pad plane geometry
+    std::shared_ptr<R3BGTPCFieldCache> fFieldCache;         //!< GLAD field resampled over the drift volume
+    std::unique_ptr<R3BGTPCDriftStepper> fStepper;          //!< Langevin stepper for electron packets
+    R3BGTPCDriftStepper::EIntegrator fIntegrator;           //!< Drift integrator. Default kEuler
+    Double_t fIntegratorTolerance;                          //!< Position error per step for kRK45 [cm]
+
+    R3BGTPCDriftParameters GetDriftParameters() const;
 
     ClassDef(R3BGTPCLaserGen, 1)
 };
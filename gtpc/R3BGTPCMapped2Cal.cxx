@@ -26,11 +26,16 @@
 // R3BGTPCMapped2Cal: Constructor
 R3BGTPCMapped2Cal::R3BGTPCMapped2Cal()
     : FairTask("R3B GTPC Calibrator")
-    //    , fCalParams(NULL)
     , fCal_Par(NULL)
     , fGTPCMappedDataCA(NULL)
     , fGTPCCalDataCA(NULL)
     , fOnline(kFALSE)
+    , fZeroSuppress(kTRUE)
+    , fRunningBaseline(kFALSE)
+    , fBaselineWeight(0.05)
+    , fThreshold(0.)
+    , fPreSamples(2)
+    , fPostSamples(4)
 {
 }
 
@@ -67,10 +72,26 @@ void R3BGTPCMapped2Cal::SetParContainers()
 void R3BGTPCMapped2Cal::SetParameter()
 {
     //--- Parameter Container ---
-    /*
-        fCalParams = new TArrayF();
-        fCalParams = fCal_Par->GetCalParams(); // Array with the Cal parameters
-    */
+    // Flat per pad arrays of the calibration parameters, read once per run
+    auto par = R3BGTPCCalibrationEngine::ReadParameters(fCal_Par);
+    par.fZeroSuppress = fZeroSuppress;
+    par.fRunningBaseline = fRunningBaseline;
+    par.fBaselineWeight = fBaselineWeight;
+    par.fThreshold = fThreshold;
+    par.fPreSamples = fPreSamples;
+    par.fPostSamples = fPostSamples;
+    if (par.fPedestal.empty())
+        LOG(warn) << "R3BGTPCMapped2Cal::SetParameter: No pad calibration in GTPCCalPar, copying the ADC values";
+
+    fEngine = std::make_unique<R3BGTPCCalibrationEngine>(par);
+    // The running baselines go on from one run to the next
+    if (!fWorkspace)
+        fWorkspace = fEngine->MakeWorkspace();
+    LOG(info) << "R3BGTPCMapped2Cal: Calibration of " << fEngine->GetNumberOfPads() << " pads with "
+              << R3BGTPCCalibrationEngine::GetInstructionSet() << " kernels";
+    if (fRunningBaseline)
+        LOG(info) << "R3BGTPCMapped2Cal: Running baseline, threshold " << fThreshold << " sigma, window -"
+                  << fPreSamples << "/+" << fPostSamples << " samples";
 }
 
 InitStatus R3BGTPCMapped2Cal::Init()
@@ -105,6 +126,7 @@ InitStatus R3BGTPCMapped2Cal::Init()
 InitStatus R3BGTPCMapped2Cal::ReInit()
 {
     SetParContainers();
+    SetParameter();
     return kSUCCESS;
 }
 
@@ -119,45 +141,26 @@ void R3BGTPCMapped2Cal::Exec(Option_t* option)
     }
 
     // Reading the Input -- Mapped Data --
-    Int_t nHits = fGTPCMappedDataCA->GetEntries();
-    if (!nHits)
+    if (!fGTPCMappedDataCA->GetEntriesFast())
         return;
 
-    UShort_t pad = 0;
-    std::vector<UShort_t> adc_cal;
-
-    R3BGTPCMappedData** mappedData;
-    mappedData = new R3BGTPCMappedData*[nHits];
-
-    for (Int_t i = 0; i < nHits; i++)
-    {
-        mappedData[i] = (R3BGTPCMappedData*)(fGTPCMappedDataCA->At(i));
-        pad = mappedData[i]->GetPadId();
-        adc_cal = mappedData[i]->GetADC();
-        // just copying, calibrating should be included here
-    }
-    AddCalData(pad, adc_cal);
-
-    if (mappedData)
-        delete mappedData;
-    return;
+    // The GTPCCalData objects of the previous events are refilled in place
+    fEngine->Calibrate(*fGTPCMappedDataCA, *fGTPCCalDataCA, *fWorkspace);
 }
 
-void R3BGTPCMapped2Cal::Finish() {}
+void R3BGTPCMapped2Cal::Finish()
+{
+    if (fWorkspace && fWorkspace->nSamples > 0)
+        LOG(info) << "R3BGTPCMapped2Cal: " << fWorkspace->nSamplesKept << " of " << fWorkspace->nSamples
+                  << " samples kept (" << 100. * fWorkspace->nSamplesKept / fWorkspace->nSamples << " %)";
+}
 
 void R3BGTPCMapped2Cal::Reset()
 {
     LOG(debug) << "Clearing CalData Structure";
+    // Without the "C" option: the objects and their memory are kept as a pool
     if (fGTPCCalDataCA)
         fGTPCCalDataCA->Clear();
 }
 
-R3BGTPCCalData* R3BGTPCMapped2Cal::AddCalData(UShort_t padId, std::vector<UShort_t> adc_calib)
-{
-    // It fills the R3BGTPCCalData
-    TClonesArray& clref = *fGTPCCalDataCA;
-    Int_t size = clref.GetEntriesFast();
-    return new (clref[size]) R3BGTPCCalData(padId, adc_calib);
-}
-
 ClassImp(R3BGTPCMapped2Cal)
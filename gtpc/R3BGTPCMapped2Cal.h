@@ -16,8 +16,11 @@
 #include "FairTask.h"
 #include "R3BGTPCCalData.h"
 #include "R3BGTPCCalPar.h"
+#include "R3BGTPCCalibrationEngine.h"
 #include "R3BGTPCMappedData.h"
 
+#include <memory>
+
 class TClonesArray;
 class R3BGTPCCalPar;
 
@@ -51,23 +54,53 @@ class R3BGTPCMapped2Cal : public FairTask
 
     /** Accessor to select online mode **/
     void SetOnline(Bool_t option) { fOnline = option; }
+    /** Zero suppressed R3BGTPCCalData. Default kTRUE **/
+    void SetZeroSuppress(Bool_t option) { fZeroSuppress = option; }
+
+    /** Baseline of each pad followed from event to event and subtracted, as
+     ** well as its noise RMS, with weight the weight of each event (see
+     ** R3BGTPCCalibrationEngine). Default kFALSE **/
+    void SetRunningBaseline(Bool_t option, Float_t weight = 0.05)
+    {
+        fRunningBaseline = option;
+        fBaselineWeight = weight;
+    }
+
+    /** Zero suppression: only the samples from preSamples before to
+     ** postSamples after a sample over nSigma noise RMS above the baseline
+     ** are kept, and only the pads with such a sample. Sets the running
+     ** baseline on. Default nSigma 0, all the samples are kept **/
+    void SetThreshold(Float_t nSigma, Int_t preSamples = 2, Int_t postSamples = 4)
+    {
+        fThreshold = nSigma;
+        fPreSamples = preSamples;
+        fPostSamples = postSamples;
+        if (nSigma > 0.)
+            fRunningBaseline = kTRUE;
+    }
+
+    /** Calibration kernel built in Init/ReInit. It can be shared with other
+     ** threads calibrating their own events, each with its own workspace **/
+    const R3BGTPCCalibrationEngine* GetEngine() const { return fEngine.get(); }
 
   private:
     void SetParameter();
 
-    // TArrayF* fCalParams;
-    // or maybe
-    // Double_t fCalParam;
-
     R3BGTPCCalPar* fCal_Par;         /**< Parameter container. >*/
     TClonesArray* fGTPCMappedDataCA; /**< Array with GTPC Mapped- input data. >*/
     TClonesArray* fGTPCCalDataCA;    /**< Array with GTPC Cal- output data. >*/
 
-    Bool_t fOnline; // Selector for online data storage
+    Bool_t fOnline;       // Selector for online data storage
+    Bool_t fZeroSuppress; // Zero suppressed R3BGTPCCalData
+
+    Bool_t fRunningBaseline; // Running baseline subtraction and noise estimation
+    Float_t fBaselineWeight; // Weight of an event in the running baseline and noise
+    Float_t fThreshold;      // Zero suppression threshold [noise RMS], 0 none
+    Int_t fPreSamples;       // Samples kept before a sample over threshold
+    Int_t fPostSamples;      // Samples kept after a sample over threshold
 
-    /** Private method AddCalData **/
-    //** Adds a GTPCCalData to the CalCollection
-    R3BGTPCCalData* AddCalData(UShort_t padId, std::vector<UShort_t> adc_calib);
+    std::unique_ptr<R3BGTPCCalibrationEngine> fEngine;               //! Calibration kernel of the current parameters
+    std::unique_ptr<R3BGTPCCalibrationEngine::Workspace> fWorkspace; //!< Memory of the events of this task
 
     ClassDef(R3BGTPCMapped2Cal, 1)
 };
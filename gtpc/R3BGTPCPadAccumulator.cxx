@@ -0,0 +1,72 @@
+/******************************************************************************
+ *   Copyright (C) 2018 GSI Helmholtzzentrum für Schwerionenforschung GmbH    *
+ *   Copyright (C) 2018-2025 Members of R3B Collaboration                     *
+ *                                                                            *
+ *             This software is distributed under the terms of the            *
+ *                 GNU Lesser General Public Licence (LGPL) version 3,        *
+ *                    copied verbatim in the file "LICENSE".                  *
+ *                                                                            *
+ * In applying this license GSI does not waive the privileges and immunities  *
+ * granted to it by virtue of its status as an Intergovernmental Organization *
+ * or submit itself to any jurisdiction.                                      *
+ ******************************************************************************/
+
+#include "R3BGTPCPadAccumulator.h"
+
+#include <algorithm>
+
+R3BGTPCPadAccumulator::R3BGTPCPadAccumulator(Int_t nPads, Int_t nTimeBins)
+    : fNPads(nPads)
+    , fNTimeBins(nTimeBins)
+    , fRowOfPad(nPads, -1)
+{
+}
+
+void R3BGTPCPadAccumulator::Reset()
+{
+    for (Int_t pad : fTouchedPads)
+        fRowOfPad[pad] = -1;
+    std::fill(fCounts.begin(), fCounts.begin() + (size_t)fTouchedPads.size() * fNTimeBins, 0.);
+    fTouchedPads.clear();
+}
+
+Int_t R3BGTPCPadAccumulator::Touch(Int_t pad)
+{
+    if (pad < 0 || pad >= fNPads)
+        return -1;
+    Int_t row = fRowOfPad[pad];
+    if (row >= 0)
+        return row;
+
+    row = fTouchedPads.size();
+    fRowOfPad[pad] = row;
+    fTouchedPads.push_back(pad);
+    // rows of the pool are kept cleared, grow it only when needed
+    if (fCounts.size() < (size_t)(row + 1) * fNTimeBins)
+        fCounts.resize((size_t)(row + 1) * fNTimeBins, 0.);
+    return row;
+}
+
+Bool_t R3BGTPCPadAccumulator::Add(Int_t pad, Int_t timeBin, Double_t electrons)
+{
+    Int_t row = Touch(pad);
+    if (row < 0 || timeBin < 0 || timeBin >= fNTimeBins)
+        return kFALSE;
+    fCounts[(size_t)row * fNTimeBins + timeBin] += electrons;
+    return kTRUE;
+}
+
+void R3BGTPCPadAccumulator::Add(const R3BGTPCPadAccumulator& other)
+{
+    Int_t nTimeBins = std::min(fNTimeBins, other.fNTimeBins);
+    for (size_t otherRow = 0; otherRow < other.fTouchedPads.size(); otherRow++)
+    {
+        Int_t row = Touch(other.fTouchedPads[otherRow]);
+        if (row < 0)
+            continue;
+        const Double_t* from = other.GetTimeBins(otherRow);
+        Double_t* to = GetTimeBins(row);
+        for (Int_t bin = 0; bin < nTimeBins; bin++)
+            to[bin] += from[bin];
+    }
+}
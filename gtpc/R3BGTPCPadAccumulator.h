@@ -0,0 +1,83 @@
+/******************************************************************************
+ *   Copyright (C) 2018 GSI Helmholtzzentrum für Schwerionenforschung GmbH    *
+ *   Copyright (C) 2018-2025 Members of R3B Collaboration                     *
+ *                                                                            *
+ *             This software is distributed under the terms of the            *
+ *                 GNU Lesser General Public Licence (LGPL) version 3,        *
+ *                    copied verbatim in the file "LICENSE".                  *
+ *                                                                            *
+ * In applying this license GSI does not waive the privileges and immunities  *
+ * granted to it by virtue of its status as an Intergovernmental Organization *
+ * or submit itself to any jurisdiction.                                      *
+ ******************************************************************************/
+
+/**  R3BGTPCPadAccumulator.h
+ * Per event pad x time counter used by the drift tasks to collect the
+ * electrons before creating the output objects
+ **/
+
+#pragma once
+
+#include "Rtypes.h"
+
+#include <vector>
+
+/**
+ * GTPC pad accumulator
+ *
+ * A pad is given a row (its time bins) the first time it is touched. The
+ * pad to row table is a direct index over all the pads, so finding a pad is
+ * O(1), and the rows are taken from a pool that keeps its memory between
+ * events: only the memory of the touched pads is used and cleared, also for
+ * large pad planes. Rows are numbered in order of first touch, which is the
+ * order the output objects were created in by the linear search.
+ *
+ * The bins hold numbers of electrons, whole when single carriers are added
+ * and fractional when the expected charge of a cloud is shared among them.
+ */
+
+class R3BGTPCPadAccumulator
+{
+  public:
+    /** Constructor
+     *@param nPads       Number of pad identifiers, valid ids are [0,nPads)
+     *@param nTimeBins   Number of time bins per pad
+     **/
+    R3BGTPCPadAccumulator(Int_t nPads, Int_t nTimeBins);
+
+    /** Destructor **/
+    ~R3BGTPCPadAccumulator() = default;
+
+    /** Forget the pads touched in the event, clearing only their rows **/
+    void Reset();
+
+    /** Row of pad, created if needed. -1 if pad is not a valid identifier **/
+    Int_t Touch(Int_t pad);
+
+    /** Row of pad, -1 if not touched yet in the event **/
+    Int_t GetRow(Int_t pad) const { return (pad >= 0 && pad < fNPads) ? fRowOfPad[pad] : -1; }
+
+    /** Add electrons to a time bin of pad. kFALSE if pad is not valid **/
+    Bool_t Add(Int_t pad, Int_t timeBin, Double_t electrons = 1.);
+
+    /** Add the touched pads of other, touching them in its order, e.g. to
+     ** merge the accumulators of several threads **/
+    void Add(const R3BGTPCPadAccumulator& other);
+
+    /** Touched pads in order of first touch (row i is GetTouchedPads()[i]) **/
+    const std::vector<Int_t>& GetTouchedPads() const { return fTouchedPads; }
+
+    /** Time bins of a row **/
+    const Double_t* GetTimeBins(Int_t row) const { return &fCounts[(size_t)row * fNTimeBins]; }
+    Double_t* GetTimeBins(Int_t row) { return &fCounts[(size_t)row * fNTimeBins]; }
+
+    Int_t GetNPads() const { return fNPads; }
+    Int_t GetNTimeBins() const { return fNTimeBins; }
+
+  private:
+    Int_t fNPads;                    //!< Number of pad identifiers
+    Int_t fNTimeBins;                //!< Number of time bins per pad
+    std::vector<Int_t> fRowOfPad;    //!< Row of each pad, -1 if not touched
+    std::vector<Int_t> fTouchedPads; //!< Pads touched in the event, by row
+    std::vector<Double_t> fCounts;   //!< Electrons, fNTimeBins per row
+};
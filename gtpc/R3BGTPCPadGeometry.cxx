@@ -0,0 +1,91 @@
+/******************************************************************************
+ *   Copyright (C) 2018 GSI Helmholtzzentrum für Schwerionenforschung GmbH    *
+ *   Copyright (C) 2018-2025 Members of R3B Collaboration                     *
+ *                                                                            *
+ *             This software is distributed under the terms of the            *
+ *                 GNU Lesser General Public Licence (LGPL) version 3,        *
+ *                    copied verbatim in the file "LICENSE".                  *
+ *                                                                            *
+ * In applying this license GSI does not waive the privileges and immunities  *
+ * granted to it by virtue of its status as an Intergovernmental Organization *
+ * or submit itself to any jurisdiction.                                      *
+ ******************************************************************************/
+
+#include "R3BGTPCPadGeometry.h"
+
+#include "FairLogger.h"
+
+#include <mutex>
+
+R3BGTPCPadGeometry::R3BGTPCPadGeometry(Int_t nColumns, Int_t nRows, Double_t padSize)
+    : fNColumns(nColumns)
+    , fNRows(nRows)
+    , fPadSize(padSize)
+    , fInvPadSize(1. / padSize)
+{
+    fNeighbours4 = MakeNeighbours(1.);
+    fNeighbours8 = MakeNeighbours(std::sqrt(2.));
+}
+
+R3BGTPCPadGeometry::R3BGTPCPadGeometry(R3BGTPCGeoPar* geoPar, Double_t padSize)
+    : R3BGTPCPadGeometry(std::lround(geoPar->GetActiveRegionz() * 10. / padSize),
+                         std::lround(geoPar->GetActiveRegionx() * 10. / padSize),
+                         padSize)
+{
+    LOG(info) << "R3BGTPCPadGeometry: " << fNColumns << " x " << fNRows << " pads of " << fPadSize << " mm";
+}
+
+std::shared_ptr<const R3BGTPCPadGeometry> R3BGTPCPadGeometry::Instance(R3BGTPCGeoPar* geoPar, Double_t padSize)
+{
+    static std::mutex instanceMutex;
+    static std::shared_ptr<const R3BGTPCPadGeometry> instance;
+
+    if (!geoPar || padSize <= 0.)
+    {
+        LOG(error) << "R3BGTPCPadGeometry::Instance: No geometry parameters or no pad size";
+        return nullptr;
+    }
+
+    Int_t nColumns = std::lround(geoPar->GetActiveRegionz() * 10. / padSize);
+    Int_t nRows = std::lround(geoPar->GetActiveRegionx() * 10. / padSize);
+
+    std::lock_guard<std::mutex> lock(instanceMutex);
+    if (instance && instance->fNColumns == nColumns && instance->fNRows == nRows && instance->fPadSize == padSize)
+        return instance;
+
+    instance = std::make_shared<const R3BGTPCPadGeometry>(geoPar, padSize);
+    return instance;
+}
+
+R3BGTPCPadGeometry::Neighbours R3BGTPCPadGeometry::MakeNeighbours(Double_t radius) const
+{
+    // Column and row steps to the neighbours, in increasing pad order
+    std::vector<std::pair<Int_t, Int_t>> stencil;
+    Int_t reach = (Int_t)std::floor(radius + 1e-9);
+    Double_t radius2 = radius * radius + 1e-9;
+    for (Int_t dc = -reach; dc <= reach; dc++)
+        for (Int_t dr = -reach; dr <= reach; dr++)
+            if ((dc != 0 || dr != 0) && dc * dc + dr * dr <= radius2)
+                stencil.emplace_back(dc, dr);
+
+    Neighbours table;
+    table.fOffsets.reserve(GetNumberOfPads() + 1);
+    table.fIndices.reserve((size_t)GetNumberOfPads() * stencil.size());
+    table.fOffsets.push_back(0);
+    for (Int_t column = 0; column < fNColumns; column++)
+    {
+        for (Int_t row = 0; row < fNRows; row++)
+        {
+            for (const auto& step : stencil)
+            {
+                Int_t c = column + step.first;
+                Int_t r = row + step.second;
+                if ((UInt_t)c < (UInt_t)fNColumns && (UInt_t)r < (UInt_t)fNRows)
+                    table.fIndices.push_back(GetPad(c, r));
+            }
+            table.fOffsets.push_back(table.fIndices.size());
+        }
+    }
+    table.fIndices.shrink_to_fit();
+    return table;
+}
@@ -0,0 +1,142 @@
+/******************************************************************************
+ *   Copyright (C) 2018 GSI Helmholtzzentrum für Schwerionenforschung GmbH    *
+ *   Copyright (C) 2018-2025 Members of R3B Collaboration                     *
+ *                                                                            *
+ *             This software is distributed under the terms of the            *
+ *                 GNU Lesser General Public Licence (LGPL) version 3,        *
+ *                    copied verbatim in the file "LICENSE".                  *
+ *                                                                            *
+ * In applying this license GSI does not waive the privileges and immunities  *
+ * granted to it by virtue of its status as an Intergovernmental Organization *
+ * or submit itself to any jurisdiction.                                      *
+ ******************************************************************************/
+
+/**  R3BGTPCPadGeometry.h
+ * Regular pad plane geometry, giving the pad of a point and the center of a
+ * pad by arithmetic instead of the TH2Poly of R3BGTPCMap
+ **/
+
+#pragma once
+
+#include "R3BGTPCGeoPar.h"
+#include "Rtypes.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+/**
+ * GTPC pad geometry
+ *
+ * The pad plane is a grid of square pads, nColumns along z and nRows along
+ * x, numbered as in R3BGTPCMap: pad = column * nRows + row, starting from 0.
+ * Positions are in [mm] from the corner of the pad plane, with z first as in
+ * the TH2Poly, which is left for drawing.
+ *
+ * The geometry is immutable once built: the tasks take the process-wide one
+ * of Instance, sized from R3BGTPCGeoPar, and the pad counts, index ranges and
+ * buffer sizes all follow from it.
+ *
+ * The adjacency of the pads is kept as neighbour tables in CSR form, so that
+ * clustering and charge sharing can walk the touched pads by integer index.
+ * The 4- and 8-connected tables are built with the geometry, the ones of any
+ * other radius by MakeNeighbours.
+ */
+
+class R3BGTPCPadGeometry
+{
+  public:
+    /** Neighbour table in CSR form: the neighbours of pad are
+     ** fIndices[fOffsets[pad]] ... fIndices[fOffsets[pad + 1] - 1], in
+     ** increasing pad order, without the pad itself **/
+    struct Neighbours
+    {
+        std::vector<Int_t> fOffsets; //!< First entry of each pad in fIndices, plus the total at the end
+        std::vector<Int_t> fIndices; //!< Neighbouring pads of all the pads, one after the other
+
+        Int_t GetN(Int_t pad) const { return fOffsets[pad + 1] - fOffsets[pad]; }
+        const Int_t* Begin(Int_t pad) const { return fIndices.data() + fOffsets[pad]; }
+        const Int_t* End(Int_t pad) const { return fIndices.data() + fOffsets[pad + 1]; }
+    };
+
+    enum EConnectivity
+    {
+        k4Connected, //!< Pads sharing a side
+        k8Connected  //!< Pads sharing a side or a corner
+    };
+
+    /** Constructor
+     *@param nColumns   Number of pads along z
+     *@param nRows      Number of pads along x
+     *@param padSize    Pad pitch [mm]
+     **/
+    R3BGTPCPadGeometry(Int_t nColumns, Int_t nRows, Double_t padSize = kPadSize);
+
+    /** Constructor from the active region of the geometry parameters, with
+     ** pads of padSize [mm] (the prototype gives 128 x 44 pads of kPadSize) **/
+    explicit R3BGTPCPadGeometry(R3BGTPCGeoPar* geoPar, Double_t padSize = kPadSize);
+
+    /** Destructor **/
+    ~R3BGTPCPadGeometry() = default;
+
+    /** Pad plane shared by all the tasks of the process. The last geometry
+     ** built is reused as long as geoPar and padSize give the same columns,
+     ** rows and pitch, otherwise a new one is built. nullptr without geoPar **/
+    static std::shared_ptr<const R3BGTPCPadGeometry> Instance(R3BGTPCGeoPar* geoPar, Double_t padSize = kPadSize);
+
+    /** Pad at (z,x) [mm], -1 outside the pad plane **/
+    Int_t GetPadIndex(Double_t z, Double_t x) const
+    {
+        Int_t column = (Int_t)std::floor(z * fInvPadSize);
+        Int_t row = (Int_t)std::floor(x * fInvPadSize);
+        Bool_t inside = (UInt_t)column < (UInt_t)fNColumns && (UInt_t)row < (UInt_t)fNRows;
+        return inside ? column * fNRows + row : -1;
+    }
+
+    /** Pad at (z,x) [mm], points outside are given the closest pad **/
+    Int_t GetNearestPadIndex(Double_t z, Double_t x) const
+    {
+        Int_t column = std::clamp((Int_t)std::floor(z * fInvPadSize), 0, fNColumns - 1);
+        Int_t row = std::clamp((Int_t)std::floor(x * fInvPadSize), 0, fNRows - 1);
+        return column * fNRows + row;
+    }
+
+    /** Pad of a valid column and row **/
+    Int_t GetPad(Int_t column, Int_t row) const { return column * fNRows + row; }
+
+    /** Center (z,x) [mm] of pad, which must be valid **/
+    void GetPadCenter(Int_t pad, Double_t& z, Double_t& x) const
+    {
+        z = (pad / fNRows + 0.5) * fPadSize;
+        x = (pad % fNRows + 0.5) * fPadSize;
+    }
+
+    Bool_t IsValid(Int_t pad) const { return pad >= 0 && pad < fNColumns * fNRows; }
+    Int_t GetNumberOfPads() const { return fNColumns * fNRows; }
+    Int_t GetNColumns() const { return fNColumns; }
+    Int_t GetNRows() const { return fNRows; }
+    Double_t GetPadSize() const { return fPadSize; }
+
+    /** Precomputed 4- or 8-connected neighbours **/
+    const Neighbours& GetNeighbours(EConnectivity connectivity) const
+    {
+        return connectivity == k4Connected ? fNeighbours4 : fNeighbours8;
+    }
+
+    /** Neighbours whose center is within radius [pad units] of the center of
+     ** each pad: 1 gives the 4-connected table, sqrt(2) the 8-connected one.
+     ** Built on each call, to be kept by the caller **/
+    Neighbours MakeNeighbours(Double_t radius) const;
+
+    static constexpr Double_t kPadSize = 2.; //!< Pad pitch of the GTPC pad planes [mm]
+
+  private:
+    Int_t fNColumns;      //!< Pads along z
+    Int_t fNRows;         //!< Pads along x
+    Double_t fPadSize;    //!< Pad pitch [mm]
+    Double_t fInvPadSize; //!< 1/fPadSize [mm^-1]
+
+    Neighbours fNeighbours4; //!< Pads sharing a side
+    Neighbours fNeighbours8; //!< Pads sharing a side or a corner
+};
@@ -0,0 +1,202 @@
+/******************************************************************************
+ *   Copyright (C) 2018 GSI Helmholtzzentrum für Schwerionenforschung GmbH    *
+ *   Copyright (C) 2018-2025 Members of R3B Collaboration                     *
+ *                                                                            *
+ *             This software is distributed under the terms of the            *
+ *                 GNU Lesser General Public Licence (LGPL) version 3,        *
+ *                    copied verbatim in the file "LICENSE".                  *
+ *                                                                            *
+ * In applying this license GSI does not waive the privileges and immunities  *
+ * granted to it by virtue of its status as an Intergovernmental Organization *
+ * or submit itself to any jurisdiction.                                      *
+ ******************************************************************************/
+
+#include "R3BGTPCPipeline.h"
+
+#include "FairLogger.h"
+#include "TClonesArray.h"
+#include "TROOT.h"
+#include "TTree.h"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+namespace
+{
+    Double_t SecondsSince(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<Double_t>(std::chrono::steady_clock::now() - start).count();
+    }
+} // namespace
+
+TClonesArray* R3BGTPCPipelineEvent::GetArray(const TString& branch) const
+{
+    for (const auto& array : fArrays)
+        if (branch == array.first.c_str())
+            return array.second.get();
+    return nullptr;
+}
+
+R3BGTPCPipelineEvent::Binding::~Binding()
+{
+    for (auto& saved : fSaved)
+        *saved.first = saved.second;
+}
+
+void R3BGTPCPipelineEvent::Binding::Bind(TClonesArray*& member, const char* branch)
+{
+    TClonesArray* array = fEvent.GetArray(branch);
+    if (!array)
+        LOG(fatal) << "R3BGTPCPipeline: no branch " << branch << " in the pipeline";
+    fSaved.emplace_back(&member, member);
+    member = array;
+}
+
+R3BGTPCPipeline::R3BGTPCPipeline(TTree* input, TTree* output, Int_t depth)
+    : fInput(input)
+    , fOutput(output)
+    , fDepth(std::max(1, depth))
+{
+}
+
+void R3BGTPCPipeline::AddInput(const char* branch, const char* className)
+{
+    fBranches.push_back({ branch, className, kTRUE, kFALSE });
+}
+
+void R3BGTPCPipeline::AddArray(const char* branch, const char* className, Bool_t persistent)
+{
+    fBranches.push_back({ branch, className, kFALSE, persistent });
+}
+
+void R3BGTPCPipeline::AddStage(const char* name, Stage stage)
+{
+    StageInfo info;
+    info.name = name;
+    info.stage = std::move(stage);
+    fStages.push_back(std::move(info));
+}
+
+std::unique_ptr<R3BGTPCPipelineEvent> R3BGTPCPipeline::MakeEvent() const
+{
+    auto event = std::make_unique<R3BGTPCPipelineEvent>();
+    for (const auto& branch : fBranches)
+    {
+        event->fArrays.emplace_back(branch.name, std::make_unique<TClonesArray>(branch.className.c_str()));
+        event->fAddresses.push_back(event->fArrays.back().second.get());
+    }
+    return event;
+}
+
+void R3BGTPCPipeline::Run(Long64_t first, Long64_t n)
+{
+    using Queue = R3BGTPCPipelineQueue<R3BGTPCPipelineEvent*>;
+    using Clock = std::chrono::steady_clock;
+
+    Long64_t last = fInput->GetEntries();
+    if (n >= 0)
+        last = std::min(last, first + n);
+    Int_t nStages = fStages.size();
+    Int_t nBranches = fBranches.size();
+    ROOT::EnableThreadSafety();
+
+    // Enough events for full queues plus the one each thread holds; the
+    // output thread gives them back to the input thread through free
+    Int_t nEvents = fDepth * (nStages + 1) + nStages + 2;
+    std::vector<std::unique_ptr<R3BGTPCPipelineEvent>> events;
+    Queue free(nEvents);
+    for (Int_t e = 0; e < nEvents; e++)
+    {
+        events.push_back(MakeEvent());
+        free.Push(events.back().get());
+    }
+    std::vector<std::unique_ptr<Queue>> queues;
+    for (Int_t q = 0; q <= nStages; q++)
+        queues.push_back(std::make_unique<Queue>(fDepth));
+
+    // only the input branches are read
+    fInput->SetBranchStatus("*", 0);
+    for (const auto& branch : fBranches)
+        if (branch.input)
+            fInput->SetBranchStatus((branch.name + "*").c_str(), 1);
+
+    std::vector<std::thread> threads;
+    threads.emplace_back(
+        [&]
+        {
+            for (Long64_t entry = first; entry < last; entry++)
+            {
+                R3BGTPCPipelineEvent* event = free.Pop();
+                event->fEntry = entry;
+                for (Int_t b = 0; b < nBranches; b++)
+                {
+                    if (!fBranches[b].input)
+                        continue;
+                    // the tree reads into the array pointed to by the member of the event
+                    fInput->SetBranchAddress(fBranches[b].name.c_str(), &event->fAddresses[b]);
+                    fInput->GetBranch(fBranches[b].name.c_str())->GetEntry(entry);
+                }
+                queues[0]->Push(event);
+            }
+            queues[0]->Push(nullptr);
+        });
+    for (Int_t s = 0; s < nStages; s++)
+    {
+        fStages[s].events = 0;
+        fStages[s].busy = fStages[s].waiting = 0.;
+        threads.emplace_back(
+            [&, s]
+            {
+                StageInfo& info = fStages[s];
+                while (true)
+                {
+                    auto start = Clock::now();
+                    R3BGTPCPipelineEvent* event = queues[s]->Pop();
+                    info.waiting += SecondsSince(start);
+                    if (!event)
+                        break;
+                    start = Clock::now();
+                    info.stage(*event);
+                    info.busy += SecondsSince(start);
+                    info.events++;
+                    start = Clock::now();
+                    queues[s + 1]->Push(event);
+                    info.waiting += SecondsSince(start);
+                }
+                queues[s + 1]->Push(nullptr);
+            });
+    }
+
+    // Output, in the order of the input. The new branches are created with
+    // the arrays of an event (TTree::Branch needs an existing TClonesArray of
+    // the class of the branch), then each event gives its own
+    for (Int_t b = 0; b < nBranches; b++)
+        if (fBranches[b].persistent && !fOutput->GetBranch(fBranches[b].name.c_str()))
+            fOutput->Branch(fBranches[b].name.c_str(), &events[0]->fAddresses[b]);
+    while (R3BGTPCPipelineEvent* event = queues[nStages]->Pop())
+    {
+        for (Int_t b = 0; b < nBranches; b++)
+        {
+            if (!fBranches[b].persistent)
+                continue;
+            fOutput->SetBranchAddress(fBranches[b].name.c_str(), &event->fAddresses[b]);
+        }
+        fOutput->Fill();
+        free.Push(event);
+    }
+    for (auto& thread : threads)
+        thread.join();
+    fInput->ResetBranchAddresses();
+    fOutput->ResetBranchAddresses();
+}
+
+void R3BGTPCPipeline::LogStatistics() const
+{
+    for (const auto& info : fStages)
+    {
+        LOG(info) << "R3BGTPCPipeline: stage " << info.name << ": " << info.events << " events, "
+                  << (info.events > 0 ? 1e3 * info.busy / info.events : 0.) << " ms busy and "
+                  << (info.events > 0 ? 1e3 * info.waiting / info.events : 0.) << " ms waiting per event";
+    }
+}
@@ -0,0 +1,221 @@
+/******************************************************************************
+ *   Copyright (C) 2018 GSI Helmholtzzentrum für Schwerionenforschung GmbH    *
+ *   Copyright (C) 2018-2025 Members of R3B Collaboration                     *
+ *                                                                            *
+ *             This software is distributed under the terms of the            *
+ *                 GNU Lesser General Public Licence (LGPL) version 3,        *
+ *                    copied verbatim in the file "LICENSE".                  *
+ *                                                                            *
+ * In applying this license GSI does not waive the privileges and immunities  *
+ * granted to it by virtue of its status as an Intergovernmental Organization *
+ * or submit itself to any jurisdiction.                                      *
+ ******************************************************************************/
+
+/**  R3BGTPCPipeline.h
+ * Pipelined execution of the GTPC task chain: each task runs on its own
+ * thread and the events are passed between them through bounded queues
+ **/
+
+#pragma once
+
+#include "Rtypes.h"
+#include "TString.h"
+
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class TClonesArray;
+class TTree;
+
+/**
+ * Bounded queue between one producer and one consumer thread. Push() waits
+ * while the queue is full, which is the back-pressure of a stage on the one
+ * before it, and Pop() waits while it is empty. The threads sleep on a
+ * condition variable while waiting, so idle stages leave their cores to the
+ * busy ones (e.g. the drift threads of R3BGTPCLangevin).
+ */
+
+template <typename T>
+class R3BGTPCPipelineQueue
+{
+  public:
+    explicit R3BGTPCPipelineQueue(Int_t capacity)
+        : fCapacity(capacity)
+        , fItems(capacity)
+        , fHead(0)
+        , fSize(0)
+    {
+    }
+
+    /** Add item, waiting for a free place **/
+    void Push(T item)
+    {
+        {
+            std::unique_lock<std::mutex> lock(fMutex);
+            fNotFull.wait(lock, [this] { return fSize < fCapacity; });
+            fItems[(fHead + fSize) % fCapacity] = item;
+            fSize++;
+        }
+        fNotEmpty.notify_one();
+    }
+
+    /** Take the oldest item, waiting for one **/
+    T Pop()
+    {
+        T item;
+        {
+            std::unique_lock<std::mutex> lock(fMutex);
+            fNotEmpty.wait(lock, [this] { return fSize > 0; });
+            item = fItems[fHead];
+            fHead = (fHead + 1) % fCapacity;
+            fSize--;
+        }
+        fNotFull.notify_one();
+        return item;
+    }
+
+  private:
+    const size_t fCapacity;            //!< Items it can hold
+    std::vector<T> fItems;             //!< Ring buffer
+    size_t fHead;                      //!< Next item to pop
+    size_t fSize;                      //!< Items in the queue
+    std::mutex fMutex;                 //!< Guards fItems, fHead and fSize
+    std::condition_variable fNotFull;  //!< Signalled when an item is popped
+    std::condition_variable fNotEmpty; //!< Signalled when an item is pushed
+};
+
+/**
+ * Arrays of one event in the pipeline, one per branch of the chain
+ */
+
+class R3BGTPCPipelineEvent
+{
+  public:
+    /** Entry of the event in the input tree **/
+    Long64_t GetEntry() const { return fEntry; }
+
+    /** Array of a branch, nullptr if the pipeline has no such branch **/
+    TClonesArray* GetArray(const TString& branch) const;
+
+    /** Bind() replaces the array pointed to by a task member with the array
+     ** of a branch of the event, until the binding is destroyed and the
+     ** member restored. This lets a task run its Exec() on the event without
+     ** copies **/
+    class Binding
+    {
+      public:
+        explicit Binding(const R3BGTPCPipelineEvent& event)
+            : fEvent(event)
+        {
+        }
+        Binding(const Binding&) = delete;
+        Binding& operator=(const Binding&) = delete;
+        ~Binding();
+        void Bind(TClonesArray*& member, const char* branch);
+
+      private:
+        const R3BGTPCPipelineEvent& fEvent;                           //!< Event of the arrays
+        std::vector<std::pair<TClonesArray**, TClonesArray*>> fSaved; //!< Members and their own arrays
+    };
+
+  private:
+    friend class R3BGTPCPipeline;
+
+    Long64_t fEntry = -1;                                                       //!< Entry in the input tree
+    std::vector<std::pair<std::string, std::unique_ptr<TClonesArray>>> fArrays; //!< Arrays by branch name
+    std::vector<TClonesArray*> fAddresses;                                      //!< Array pointers given to the trees
+};
+
+/**
+ * GTPC pipeline executor
+ *
+ * The input tree is read on one thread, every stage runs on its own thread
+ * and the output tree is filled on the calling thread. Events move between
+ * them through bounded queues of depth events, so a stage that is ahead
+ * waits for the next one instead of piling up events, and they keep the
+ * order of the input: the output is the same as the sequential run, while
+ * the time per event approaches that of the slowest stage.
+ *
+ * A stage must only touch its own state and the arrays of the event it is
+ * given; the GTPC tasks do so through their ExecEvent() methods, after
+ * being initialized by the FairRun as usual:
+ *
+ *   fRun->Init();
+ *   R3BGTPCPipeline pipeline(inTree, outTree);
+ *   pipeline.AddInput("GTPCPoint", "R3BGTPCPoint");
+ *   pipeline.AddInput("MCTrack", "R3BMCTrack");
+ *   pipeline.AddArray("GTPCCalData", "R3BGTPCCalData", kFALSE);
+ *   pipeline.AddArray("GTPCHitData", "R3BGTPCHitData", kTRUE);
+ *   pipeline.AddStage(langevin);
+ *   pipeline.AddStage(cal2hit);
+ *   pipeline.Run();
+ */
+
+class R3BGTPCPipeline
+{
+  public:
+    using Stage = std::function<void(R3BGTPCPipelineEvent&)>;
+
+    /** Constructor
+     *@param input    Tree the input branches are read from
+     *@param output   Tree the persistent arrays are written to
+     *@param depth    Events each queue holds at most. Default 4
+     **/
+    R3BGTPCPipeline(TTree* input, TTree* output, Int_t depth = 4);
+
+    /** Destructor **/
+    ~R3BGTPCPipeline() = default;
+
+    /** Branch read from the input tree **/
+    void AddInput(const char* branch, const char* className);
+
+    /** Array filled by a stage, written to the output tree if persistent **/
+    void AddArray(const char* branch, const char* className, Bool_t persistent);
+
+    /** Stage run on its own thread, in the order the stages are added **/
+    void AddStage(const char* name, Stage stage);
+
+    /** Stage of a task with an ExecEvent(R3BGTPCPipelineEvent&) method **/
+    template <typename Task>
+    void AddStage(Task* task)
+    {
+        AddStage(task->GetName(), [task](R3BGTPCPipelineEvent& event) { task->ExecEvent(event); });
+    }
+
+    /** Process the entries [first, first+n) of the input tree, all if n<0 **/
+    void Run(Long64_t first = 0, Long64_t n = -1);
+
+    /** Events, busy and waiting time of every stage **/
+    void LogStatistics() const;
+
+  private:
+    struct Branch
+    {
+        std::string name;
+        std::string className;
+        Bool_t input;
+        Bool_t persistent;
+    };
+
+    struct StageInfo
+    {
+        std::string name;
+        Stage stage;
+        Long64_t events = 0;
+        Double_t busy = 0.;    // [s]
+        Double_t waiting = 0.; // [s], for an event or for room downstream
+    };
+
+    TTree* fInput;                  //!< Input tree
+    TTree* fOutput;                 //!< Output tree
+    Int_t fDepth;                   //!< Capacity of the queues
+    std::vector<Branch> fBranches;  //!< Branches of the events
+    std::vector<StageInfo> fStages; //!< Stages, in order
+
+    /** New event with one empty array per branch **/
+    std::unique_ptr<R3BGTPCPipelineEvent> MakeEvent() const;
+};
@@ -12,6 +12,8 @@
  ******************************************************************************/
 
 #include "R3BGTPCProjector.h"
+#include "R3BGTPCCompactPoint.h"
+#include "R3BGTPCRandom.h"
 #include "R3BMCTrack.h"
 #include "TClonesArray.h"
 
@@ -20,13 +22,50 @@
 #include "FairRunAna.h"
 #include "FairRuntimeDb.h"
 #include "TF1.h"
+#include "TRandom.h"
 #include "TVirtualMC.h"
 #include "TVirtualMCStack.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
 using namespace std;
 
+namespace
+{
+    // Gaussian tails beyond kCloudSigmas are neglected in the charge sharing
+    constexpr Double_t kCloudSigmas = 5.;
+
+    // Fractions of a Gaussian (mean, sigma) in the bins [i*width, (i+1)*width)
+    // of [0, n), the tails going to the first and last bins as in the sampling.
+    // Fills the bins within kCloudSigmas of the mean and returns the first one
+    Int_t GaussianFractions(Double_t mean, Double_t sigma, Double_t width, Int_t n, std::vector<Double_t>& fractions)
+    {
+        fractions.clear();
+        if (sigma <= 0.)
+        {
+            fractions.push_back(1.);
+            return std::clamp((Int_t)std::floor(mean / width), 0, n - 1);
+        }
+        Int_t first = std::clamp((Int_t)std::floor((mean - kCloudSigmas * sigma) / width), 0, n - 1);
+        Int_t last = std::clamp((Int_t)std::floor((mean + kCloudSigmas * sigma) / width), 0, n - 1);
+        Double_t scale = 1. / (sqrt(2.) * sigma);
+        Double_t low = first == 0 ? -1. : erf((first * width - mean) * scale);
+        for (Int_t i = first; i <= last; i++)
+        {
+            Double_t high = i == n - 1 ? 1. : erf(((i + 1) * width - mean) * scale);
+            fractions.push_back(0.5 * (high - low));
+            low = high;
+        }
+        return first;
+    }
+} // namespace
+
 R3BGTPCProjector::R3BGTPCProjector()
     : FairTask("R3BGTPCProjector")
     , fGTPCPoints(NULL)
+    , fGTPCCompactPointsCA(NULL)
     , fGTPCCalDataCA(NULL)
     , fGTPCProjPoint(NULL)
     , MCTrackCA(NULL)
@@ -44,8 +83,12 @@ R3BGTPCProjector::R3BGTPCProjector()
     fDetectorType = 0;
     fDriftTimeStep = 0.;
     outputMode = 0;
+    fZeroSuppress = kTRUE;
+    fElectronsPerBunch = 1;
+    fAnalyticSharing = kFALSE;
+    fAnalyticPoisson = kFALSE;
+    fRunSeed = 0;
     fDriftEField = 0;
-    fTPCMap = std::make_shared<R3BGTPCMap>();
 }
 
 R3BGTPCProjector::~R3BGTPCProjector()
@@ -121,8 +164,7 @@ void R3BGTPCProjector::SetParameter()
     fDriftEField = fGTPCElecPar->GetDriftEField();     // drift E field in V/m
     fDriftTimeStep = fGTPCElecPar->GetDriftTimeStep(); // time step for drift
 
-    fGTPCElecPar->GetTimeBinSize(); // [ns]
-    fGTPCElecPar->GetTimeBinSize(); // drift params calculation
+    fTimeBinSize = fGTPCElecPar->GetTimeBinSize(); // [ns]
 }
 
 InitStatus R3BGTPCProjector::Init()
@@ -133,13 +175,20 @@ InitStatus R3BGTPCProjector::Init()
         LOG(fatal) << "R3BGTPCProjector::Init: No FairRootManager";
         return kFATAL;
     }
-    // Input: TClonesArray of R3BGTPCPoints
-    if ((TClonesArray*)ioman->GetObject("GTPCPoint") == nullptr)
+    // Input: TClonesArray of R3BGTPCPoints, or of R3BGTPCCompactPoints
+    // expanded every event into fGTPCPoints
+    if ((TClonesArray*)ioman->GetObject("GTPCPoint") != nullptr)
+        fGTPCPoints = (TClonesArray*)ioman->GetObject("GTPCPoint");
+    else if ((TClonesArray*)ioman->GetObject("GTPCCompactPoint") != nullptr)
+    {
+        fGTPCCompactPointsCA = (TClonesArray*)ioman->GetObject("GTPCCompactPoint");
+        fGTPCPoints = new TClonesArray("R3BGTPCPoint");
+    }
+    else
     {
         LOG(fatal) << "R3BGTPCProjector::Init No GTPCPoint!";
         return kFATAL;
     }
-    fGTPCPoints = (TClonesArray*)ioman->GetObject("GTPCPoint");
     // Input: TClonesArray of R3BMCTrack
     if ((TClonesArray*)ioman->GetObject("MCTrack") == nullptr)
     {
@@ -161,17 +210,19 @@ InitStatus R3BGTPCProjector::Init()
     }
 
     SetParameter();
+    fRunSeed = R3BGTPCRandom::MakeRunSeed(fRunSeed);
+    LOG(info) << "R3BGTPCProjector::Init: Random seed of the run " << fRunSeed;
 
-    // Pad plane generation
-    fTPCMap->GeneratePadPlane();
-    fPadPlane = fTPCMap->GetPadPlane();
+    // Pad plane geometry
+    fPadGeometry = R3BGTPCPadGeometry::Instance(fGTPCGeoPar);
+    // All the pads with 512 time bins each (as in R3BGTPCCalData)
+    fPadAccumulator = std::make_unique<R3BGTPCPadAccumulator>(fPadGeometry->GetNumberOfPads(), 512);
 
-    if (fPadPlane == NULL)
+    if (fAnalyticSharing && outputMode != 0)
     {
-        std::cout << " R3BGTPCProjector::Init() error! - Could not retrieve pad "
-                     "plane. Exiting..."
-                  << "\n";
-        return kERROR;
+        LOG(warn) << "R3BGTPCProjector::Init Analytic charge sharing needs the CalData output, "
+                     "drifting single electrons";
+        fAnalyticSharing = kFALSE;
     }
 
     return kSUCCESS;
@@ -207,6 +258,11 @@ void R3BGTPCProjector::Exec(Option_t*)
     {
         fGTPCProjPoint->Clear("C");
     }
+    fPadAccumulator->Reset();
+
+    // the names of the points are not needed for the digitization
+    if (fGTPCCompactPointsCA)
+        R3BGTPCCompactPoint::Expand(fGTPCCompactPointsCA, fGTPCPoints);
 
     Int_t nPoints = fGTPCPoints->GetEntries();
     LOG(info) << "R3BGTPCProjector: processing " << nPoints << " points";
@@ -224,7 +280,6 @@ void R3BGTPCProjector::Exec(Option_t*)
     Double_t energyDep = 0.;
     Double_t timeBeforeDrift = 0.;
     Bool_t readyToProject = kFALSE;
-    Bool_t padFound = kFALSE;
     Int_t electrons = 0;
     Int_t flucElectrons = 0;
     Int_t generatedElectrons = 0;
@@ -233,9 +288,14 @@ void R3BGTPCProjector::Exec(Option_t*)
     Double_t sigmaLongAtPadPlane;
     Double_t sigmaTransvAtPadPlane;
     Int_t evtID = 0;
+    // the electrons of point i are generated and smeared from stream i of the
+    // event, the event being the one of the points
+    UInt_t eventID = ((R3BGTPCPoint*)fGTPCPoints->At(0))->GetEventID();
+    R3BGTPCRandom rnd;
     for (Int_t i = 0; i < nPoints; i++)
     {
         aPoint = (R3BGTPCPoint*)fGTPCPoints->At(i);
+        rnd.SetSeed(fRunSeed, eventID, i);
         evtID = aPoint->GetEventID();
         Int_t PDGCode = 0, MotherId = 0;
         Double_t Vertex_x0 = 0, Vertex_y0 = 0, Vertex_z0 = 0, Vertex_px0 = 0, Vertex_py0 = 0, Vertex_pz0 = 0;
@@ -291,7 +351,7 @@ void R3BGTPCProjector::Exec(Option_t*)
         // electron number fluctuates as the square root of the
         // Fano factor times the number of electrons
         flucElectrons = pow(fFanoFactor * electrons, 0.5);
-        generatedElectrons = gRandom->Gaus(electrons, flucElectrons); // generated electrons
+        generatedElectrons = rnd.Gaus(electrons, flucElectrons); // generated electrons
 
         // step in each direction for an homogeneous electron creation position
         // along the track
@@ -308,12 +368,31 @@ void R3BGTPCProjector::Exec(Option_t*)
         sigmaLongAtPadPlane = sqrt(driftDistance * 2 * fLongDiff / fDriftVelocity);
         sigmaTransvAtPadPlane = sqrt(driftDistance * 2 * fTransDiff / fDriftVelocity);
 
-        for (Int_t ele = 1; ele <= generatedElectrons; ele++) // following each electrons from production to pad
+        if (fAnalyticSharing)
+        { // expected charge of the whole step, no electron is drifted
+            Double_t pre[3] = { xPre, yPre, zPre };
+            Double_t post[3] = { xPost, yPost, zPost };
+            ShareCharge(generatedElectrons, pre, post, timeBeforeDrift, sigmaTransvAtPadPlane, sigmaLongAtPadPlane);
+            xPre = xPost;
+            yPre = yPost;
+            zPre = zPost;
+            continue;
+        }
+
+        for (Int_t ele = 1; ele <= generatedElectrons;
+             ele += fElectronsPerBunch) // following each electrons (or bunch) from production to pad
         {
-            driftTime = ((yPre + stepY * ele) + fHalfSizeTPC_Y) / fDriftVelocity;
-            projX = gRandom->Gaus(xPre + stepX * ele, sigmaTransvAtPadPlane);
-            projZ = gRandom->Gaus(zPre + stepZ * ele, sigmaTransvAtPadPlane);
-            projTime = gRandom->Gaus(driftTime + timeBeforeDrift, sigmaLongAtPadPlane / fDriftVelocity);
+            // a bunch is drifted as one carrier placed uniformly in the part of
+            // the step of its electrons, as in R3BGTPCLangevin, with the single
+            // electron diffusion, and weights the output with its size
+            Int_t bunchWeight = std::min(fElectronsPerBunch, generatedElectrons - ele + 1);
+            Double_t eleStart = ele;
+            if (bunchWeight > 1)
+                eleStart = ele - 1 + bunchWeight * rnd.Rndm();
+            driftTime = ((yPre + stepY * eleStart) + fHalfSizeTPC_Y) / fDriftVelocity;
+            projX = rnd.Gaus(xPre + stepX * eleStart, sigmaTransvAtPadPlane);
+            projZ = rnd.Gaus(zPre + stepZ * eleStart, sigmaTransvAtPadPlane);
+            projTime = rnd.Gaus(driftTime + timeBeforeDrift, sigmaLongAtPadPlane / fDriftVelocity);
             // cout<<"projTime="<<projTime<<"		driftTime="<<driftTime<<"
             // timeBeforeDrift="<<timeBeforeDrift<<endl; cout<<"ProjZ="<<projZ<<"
             // ProjX="<<projX<<endl; obtain padID for projX, projZ (simple algorithm)
@@ -336,73 +415,47 @@ void R3BGTPCProjector::Exec(Option_t*)
                 projX = fOffsetX + 2 * fHalfSizeTPC_X;
 
             // std::cout<<" proj Z "<<projZ<<" - proj Y "<<projY<<"\n";
-            Int_t padID = fPadPlane->Fill((projZ - fOffsetZ) * 10.0,
-                                          (projX - fOffsetX) * 10.0); // in mm
+            // The edges of the pad plane go to the border pads
+            Int_t padID = fPadGeometry->GetNearestPadIndex((projZ - fOffsetZ) * 10.0,
+                                                           (projX - fOffsetX) * 10.0); // in mm
 
             if (outputMode == 0)
-            { // Output: TClonesArray of R3BGTPCCalData
-                Int_t nCalData = fGTPCCalDataCA->GetEntriesFast();
-                for (Int_t pp = 0; pp < nCalData; pp++)
-                {
-                    if (((R3BGTPCCalData*)fGTPCCalDataCA->At(pp))->GetPadId() == padID)
-                    {
-                        // already existing R3BGTPCCalData... add time and electron
-                        projTime = projTime / fTimeBinSize; // moving from ns to binsize
-                        if (projTime < 0)
-                            projTime = 0; // Fills (first) underflow bin
-                        else if (projTime > 511)
-                            projTime = 511; // Fills (last) overflow bin
-                        ((R3BGTPCCalData*)fGTPCCalDataCA->At(pp))->SetADC(projTime);
-                        padFound = kTRUE;
-                        break;
-                    }
-                }
-                if (!padFound)
-                {
-                    std::vector<UShort_t> adc(512, 0);
-                    projTime = projTime / fTimeBinSize; // moving from ns to binsize
-                    if (projTime < 0)
-                        projTime = 0; // Fills (first) underflow bin
-                    else if (projTime > 511)
-                        projTime = 511; // Fills (last) overflow bin
-                    adc.at(projTime)++;
-
-                    new ((*fGTPCCalDataCA)[nCalData]) R3BGTPCCalData(padID, adc);
-                }
-                padFound = kFALSE;
+            { // Output: R3BGTPCCalData, created from the accumulator at the end of Exec
+                projTime = projTime / fTimeBinSize; // moving from ns to binsize
+                if (projTime < 0)
+                    projTime = 0; // Fills (first) underflow bin
+                else if (projTime > 511)
+                    projTime = 511; // Fills (last) overflow bin
+                if (!fPadAccumulator->Add(padID, projTime, bunchWeight))
+                    LOG(warn) << "R3BGTPCProjector::Exec No-valid padID " << padID;
             }
             else if (outputMode == 1)
-            {
-
-                Int_t nProjPoints = fGTPCProjPoint->GetEntriesFast();
-
-                for (Int_t pp = 0; pp < nProjPoints; pp++)
+            { // Output: TClonesArray of R3BGTPCProjPoint, with the same index as the pad row
+                Int_t row = fPadAccumulator->GetRow(padID);
+                if (row >= 0)
                 {
-                    if (((R3BGTPCProjPoint*)fGTPCProjPoint->At(pp))->GetVirtualPadID() == padID)
-                    {
-                        // already existing R3BGTPCProjPoint... add time and electron
-                        ((R3BGTPCProjPoint*)fGTPCProjPoint->At(pp))->AddCharge();                      //
-                        ((R3BGTPCProjPoint*)fGTPCProjPoint->At(pp))->SetTimeDistr(projTime / 1000, 1); // micros
-                        padFound = kTRUE;
-                        break;
-                    }
+                    // already existing R3BGTPCProjPoint... add time and electron
+                    ((R3BGTPCProjPoint*)fGTPCProjPoint->At(row))->AddCharge(bunchWeight);
+                    ((R3BGTPCProjPoint*)fGTPCProjPoint->At(row))
+                        ->SetTimeDistr(projTime / 1000, bunchWeight); // micros
                 }
-                if (!padFound)
+                else if ((row = fPadAccumulator->Touch(padID)) >= 0)
                 {
-                    new ((*fGTPCProjPoint)[nProjPoints]) R3BGTPCProjPoint(padID,
-                                                                          projTime / 1000, // micros
-                                                                          1,
-                                                                          evtID,
-                                                                          PDGCode,
-                                                                          MotherId,
-                                                                          Vertex_x0,
-                                                                          Vertex_y0,
-                                                                          Vertex_z0,
-                                                                          Vertex_px0,
-                                                                          Vertex_py0,
-                                                                          Vertex_pz0);
+                    new ((*fGTPCProjPoint)[row]) R3BGTPCProjPoint(padID,
+                                                                  projTime / 1000, // micros
+                                                                  bunchWeight,
+                                                                  evtID,
+                                                                  PDGCode,
+                                                                  MotherId,
+                                                                  Vertex_x0,
+                                                                  Vertex_y0,
+                                                                  Vertex_z0,
+                                                                  Vertex_px0,
+                                                                  Vertex_py0,
+                                                                  Vertex_pz0);
                 }
-                padFound = kFALSE;
+                else
+                    LOG(warn) << "R3BGTPCProjector::Exec No-valid padID " << padID;
             }
         }
 
@@ -411,9 +464,84 @@ void R3BGTPCProjector::Exec(Option_t*)
         zPre = zPost;
 
     } // Simulated points
+
+    if (outputMode == 0)
+    { // one R3BGTPCCalData per touched pad, in order of first touch
+        const auto& pads = fPadAccumulator->GetTouchedPads();
+        std::vector<UShort_t> adc(fPadAccumulator->GetNTimeBins());
+        // the expected charge is rounded, or drawn from its own stream
+        rnd.SetSeed(fRunSeed, eventID, R3BGTPCRandom::kEventStream);
+        for (size_t row = 0; row < pads.size(); row++)
+        {
+            const Double_t* counts = fPadAccumulator->GetTimeBins(row);
+            for (size_t bin = 0; bin < adc.size(); bin++)
+            {
+                Double_t charge = fAnalyticPoisson && fAnalyticSharing ? rnd.Poisson(counts[bin]) : round(counts[bin]);
+                adc[bin] = std::min<Double_t>(charge, kMaxUShort);
+            }
+            new ((*fGTPCCalDataCA)[row]) R3BGTPCCalData(pads[row], adc, fZeroSuppress);
+        }
+    }
     LOG(info) << "R3BGTPCProjector: produced " << fGTPCProjPoint->GetEntries() << " projPoints";
 }
 
+void R3BGTPCProjector::ShareCharge(Int_t electrons,
+                                   const Double_t* pre,
+                                   const Double_t* post,
+                                   Double_t timeBeforeDrift,
+                                   Double_t sigmaTransv,
+                                   Double_t sigmaLong)
+{
+    if (electrons <= 0)
+        return;
+
+    // pad plane coordinates [mm] and time [ns] at both ends of the step
+    Double_t zPre = (pre[2] - fOffsetZ) * 10., zPost = (post[2] - fOffsetZ) * 10.;
+    Double_t xPre = (pre[0] - fOffsetX) * 10., xPost = (post[0] - fOffsetX) * 10.;
+    Double_t tPre = timeBeforeDrift + (pre[1] + fHalfSizeTPC_Y) / fDriftVelocity;
+    Double_t tPost = timeBeforeDrift + (post[1] + fHalfSizeTPC_Y) / fDriftVelocity;
+    Double_t sigmaPlane = sigmaTransv * 10.;         // [mm]
+    Double_t sigmaTime = sigmaLong / fDriftVelocity; // [ns]
+    Double_t padSize = fPadGeometry->GetPadSize();
+
+    // The step is cut in clouds no longer than half a sigma or half a pad (or
+    // time bin), so the uniform charge along it is well described by the sum
+    // of their Gaussians; never more clouds than electrons
+    Double_t planeLength = std::hypot(zPost - zPre, xPost - xPre);
+    Double_t timeLength = std::fabs(tPost - tPre);
+    Double_t nCuts = std::max(planeLength / (0.5 * std::max(sigmaPlane, padSize)),
+                              timeLength / (0.5 * std::max(sigmaTime, fTimeBinSize)));
+    Int_t nClouds = std::min<Double_t>(electrons, 1. + std::floor(nCuts));
+    Double_t cloudCharge = (Double_t)electrons / nClouds;
+
+    for (Int_t cloud = 0; cloud < nClouds; cloud++)
+    {
+        Double_t f = (cloud + 0.5) / nClouds;
+        Int_t firstColumn = GaussianFractions(
+            zPre + f * (zPost - zPre), sigmaPlane, padSize, fPadGeometry->GetNColumns(), fColumnFractions);
+        Int_t firstRow = GaussianFractions(
+            xPre + f * (xPost - xPre), sigmaPlane, padSize, fPadGeometry->GetNRows(), fRowFractions);
+        Int_t firstBin = GaussianFractions(
+            tPre + f * (tPost - tPre), sigmaTime, fTimeBinSize, fPadAccumulator->GetNTimeBins(), fTimeFractions);
+
+        for (size_t c = 0; c < fColumnFractions.size(); c++)
+            for (size_t r = 0; r < fRowFractions.size(); r++)
+            {
+                Int_t padID = fPadGeometry->GetPad(firstColumn + c, firstRow + r);
+                Int_t row = fPadAccumulator->Touch(padID);
+                if (row < 0)
+                {
+                    LOG(warn) << "R3BGTPCProjector::ShareCharge No-valid padID " << padID;
+                    continue;
+                }
+                Double_t padCharge = cloudCharge * fColumnFractions[c] * fRowFractions[r];
+                Double_t* bins = fPadAccumulator->GetTimeBins(row) + firstBin;
+                for (size_t b = 0; b < fTimeFractions.size(); b++)
+                    bins[b] += padCharge * fTimeFractions[b];
+            }
+    }
+}
+
 void R3BGTPCProjector::Finish() {}
 
 ClassImp(R3BGTPCProjector)
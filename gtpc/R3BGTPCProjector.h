@@ -23,11 +23,14 @@
 #include "R3BGTPCElecPar.h"
 #include "R3BGTPCGasPar.h"
 #include "R3BGTPCGeoPar.h"
-#include "R3BGTPCMap.h"
+#include "R3BGTPCPadAccumulator.h"
+#include "R3BGTPCPadGeometry.h"
 #include "R3BGTPCPoint.h"
 #include "R3BGTPCProjPoint.h"
 #include "TClonesArray.h"
 
+#include <vector>
+
 /**
  * GTPC point projector task
  * @author Héctor Alvarez Pol
@@ -35,6 +38,8 @@
  * For each event, get the R3BGTPCPoints and determine the projection on the pad
  * plane Input:  Branch GTPCPoints = TClonesArray("R3BGTPCPoint") Output: Branch
  * GTPCProjPoint = TClonesArray("R3BGTPCProjPoint")
+ * Input alternatively from the compact Branch GTPCCompactPoint =
+ * TClonesArray("R3BGTPCCompactPoint"), see R3BGTPC::SetCompactPoints
  *
  * Updated (@author Yassid Ayyad)
  *  Added R3BGTPCMap as map manager
@@ -59,6 +64,29 @@ class R3BGTPCProjector : public FairTask
     void SetProjPointsAsOutput() { outputMode = 1; }
     void SetCalDataAsOutput() { outputMode = 0; }
 
+    /** Store in each R3BGTPCCalData only its non-zero time buckets, when it
+     ** takes less space. Default kTRUE **/
+    void SetZeroSuppressedCalData(Bool_t suppress) { fZeroSuppress = suppress; }
+
+    /** Drift the ionization electrons in bunches of n, each bunch as a single
+     ** carrier weighting n in the output, started at a random place of the
+     ** part of the step its electrons come from. Default 1 (every electron) **/
+    void SetElectronsPerBunch(Int_t n) { fElectronsPerBunch = n > 1 ? n : 1; }
+
+    /** Instead of drifting each electron, share the expected charge of the
+     ** Gaussian cloud of each step among the pads and time bins, integrating it
+     ** over their boundaries (CalData output only). With poisson the charge of
+     ** each pad and time bin is then drawn from a Poisson distribution **/
+    void SetAnalyticChargeSharing(Bool_t analytic, Bool_t poisson = kFALSE)
+    {
+        fAnalyticSharing = analytic;
+        fAnalyticPoisson = poisson;
+    }
+
+    /** Seed of the random streams of the run, keyed then by event ID and point
+     ** (see R3BGTPCRandom). Default 0: drawn from gRandom in Init **/
+    void SetRunSeed(ULong64_t seed) { fRunSeed = seed; }
+
   protected:
     /** Virtual method Init **/
     virtual InitStatus Init();
@@ -75,6 +103,7 @@ class R3BGTPCProjector : public FairTask
     void SetParameter();
 
     TClonesArray* fGTPCPoints;
+    TClonesArray* fGTPCCompactPointsCA;
     TClonesArray* fGTPCProjPoint;
     TClonesArray* fGTPCCalDataCA;
     // MCTrack- vertex information
@@ -100,13 +129,32 @@ class R3BGTPCProjector : public FairTask
     Int_t fDetectorType;     //!< Detector type: 1 for prototype, 2 for FullBeamIn, 3
                              //!< for FullBeamOut
     Int_t outputMode;        //!< Selects Cal(0) or ProjPoint(1) as output level. Default 0
+    Bool_t fZeroSuppress;    //!< Zero suppressed R3BGTPCCalData. Default kTRUE
+
+    Int_t fElectronsPerBunch; //!< Electrons drifted together as one carrier. Default 1
+    Bool_t fAnalyticSharing;  //!< Expected charge of the steps shared among pads and bins. Default kFALSE
+    Bool_t fAnalyticPoisson;  //!< Poisson draw of the shared charge of each bin. Default kFALSE
+    ULong64_t fRunSeed;       //!< Seed of the random streams of the run
 
     R3BGTPCGeoPar* fGTPCGeoPar;   //!< Geometry parameter container
     R3BGTPCGasPar* fGTPCGasPar;   //!< Gas parameter container
     R3BGTPCElecPar* fGTPCElecPar; //!< Electronics parameter container
 
-    std::shared_ptr<R3BGTPCMap> fTPCMap; //!< Map container
-    TH2Poly* fPadPlane;                  //!< Pad Plane object
+    std::shared_ptr<const R3BGTPCPadGeometry> fPadGeometry; //!< Pad plane geometry
+    std::unique_ptr<R3BGTPCPadAccumulator> fPadAccumulator; //!< Electrons per pad and time bin in the event
+    std::vector<Double_t> fColumnFractions;                 //!< Charge fractions of a cloud per pad column
+    std::vector<Double_t> fRowFractions;                    //!< Charge fractions of a cloud per pad row
+    std::vector<Double_t> fTimeFractions;                   //!< Charge fractions of a cloud per time bin
+
+    /** Share the expected charge of electrons created uniformly from pre to
+     ** post (x,y,z) [cm] and diffused with sigmaTransv, sigmaLong [cm] at the
+     ** pad plane among the pads and time bins of the accumulator **/
+    void ShareCharge(Int_t electrons,
+                     const Double_t* pre,
+                     const Double_t* post,
+                     Double_t timeBeforeDrift,
+                     Double_t sigmaTransv,
+                     Double_t sigmaLong);
 
     ClassDef(R3BGTPCProjector, 1)
 };
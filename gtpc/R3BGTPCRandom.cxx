@@ -0,0 +1,246 @@
+/******************************************************************************
+ *   Copyright (C) 2018 GSI Helmholtzzentrum für Schwerionenforschung GmbH    *
+ *   Copyright (C) 2018-2025 Members of R3B Collaboration                     *
+ *                                                                            *
+ *             This software is distributed under the terms of the            *
+ *                 GNU Lesser General Public Licence (LGPL) version 3,        *
+ *                    copied verbatim in the file "LICENSE".                  *
+ *                                                                            *
+ * In applying this license GSI does not waive the privileges and immunities  *
+ * granted to it by virtue of its status as an Intergovernmental Organization *
+ * or submit itself to any jurisdiction.                                      *
+ ******************************************************************************/
+
+#include "R3BGTPCRandom.h"
+
+#include "TRandom.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace
+{
+    // Philox4x32 constants (Salmon et al., SC11)
+    constexpr uint32_t kPhiloxM0 = 0xD2511F53;
+    constexpr uint32_t kPhiloxM1 = 0xCD9E8D57;
+    constexpr uint32_t kPhiloxW0 = 0x9E3779B9;
+    constexpr uint32_t kPhiloxW1 = 0xBB67AE85;
+    constexpr Int_t kPhiloxRounds = 10;
+
+    constexpr Int_t kBlocks = R3BGTPCRandom::kBufferSize / 2; // two deviates per block
+    constexpr Double_t kTwoPi = 6.283185307179586;
+    constexpr Double_t k2Pow52 = 4503599627370496.;   // uniforms are (i+0.5)/2^52, never 0 or 1
+    constexpr ULong64_t kUniformBlocks = 1ULL << 63;  // first block of the uniform part of a stream
+    constexpr ULong64_t kElectronBlocks = 1ULL << 62; // first block of the electron substreams
+
+    // One Philox4x32-10 block: the counter c is replaced by its random bits
+    inline void Philox(uint32_t* c, uint32_t k0, uint32_t k1)
+    {
+        for (Int_t r = 0; r < kPhiloxRounds; r++)
+        {
+            uint64_t p0 = (uint64_t)kPhiloxM0 * c[0];
+            uint64_t p1 = (uint64_t)kPhiloxM1 * c[2];
+            uint32_t n0 = (uint32_t)(p1 >> 32) ^ c[1] ^ k0;
+            uint32_t n2 = (uint32_t)(p0 >> 32) ^ c[3] ^ k1;
+            c[1] = (uint32_t)p1;
+            c[3] = (uint32_t)p0;
+            c[0] = n0;
+            c[2] = n2;
+            k0 += kPhiloxW0;
+            k1 += kPhiloxW1;
+        }
+    }
+
+    // Uniform deviate from the 64 random bits (hi, lo). 52 bits, so that
+    // i+0.5 and the largest value 1-2^-53 are exact in double precision
+    inline Double_t ToUniform(uint32_t hi, uint32_t lo)
+    {
+        uint64_t i = (((uint64_t)hi << 32) | lo) >> 12;
+        return ((Double_t)i + 0.5) / k2Pow52;
+    }
+} // namespace
+
+R3BGTPCRandom::R3BGTPCRandom(ULong64_t seed, UInt_t event, UInt_t stream)
+{
+    SetSeed(seed, event, stream);
+}
+
+void R3BGTPCRandom::SetSeed(ULong64_t seed, UInt_t event, UInt_t stream)
+{
+    fKey[0] = seed;
+    fKey[1] = seed >> 32;
+    fEvent = event;
+    fStream = stream;
+    fBlock = 0;
+    fNext = kBufferSize;
+    fUniformBlock = kUniformBlocks;
+    fNextUniform = kBufferSize;
+}
+
+void R3BGTPCRandom::FillGaus(Double_t* out, Int_t n)
+{
+    while (n > 0)
+    {
+        if (fNext == kBufferSize)
+            Fill();
+        Int_t m = std::min(n, kBufferSize - fNext);
+        std::copy(fNormal + fNext, fNormal + fNext + m, out);
+        fNext += m;
+        out += m;
+        n -= m;
+    }
+}
+
+void R3BGTPCRandom::Generate(ULong64_t block, Double_t* uniform) const
+{
+    // Counter words of the blocks, as separate arrays so each round is the
+    // same instruction over all the blocks
+    uint32_t c0[kBlocks], c1[kBlocks], c2[kBlocks], c3[kBlocks];
+    for (Int_t b = 0; b < kBlocks; b++)
+    {
+        c0[b] = block + b;
+        c1[b] = (block + b) >> 32;
+        c2[b] = fEvent;
+        c3[b] = fStream;
+    }
+
+    uint32_t k0 = fKey[0];
+    uint32_t k1 = fKey[1];
+    for (Int_t r = 0; r < kPhiloxRounds; r++)
+    {
+        for (Int_t b = 0; b < kBlocks; b++)
+        {
+            uint64_t p0 = (uint64_t)kPhiloxM0 * c0[b];
+            uint64_t p1 = (uint64_t)kPhiloxM1 * c2[b];
+            uint32_t n0 = (uint32_t)(p1 >> 32) ^ c1[b] ^ k0;
+            uint32_t n2 = (uint32_t)(p0 >> 32) ^ c3[b] ^ k1;
+            c1[b] = (uint32_t)p1;
+            c3[b] = (uint32_t)p0;
+            c0[b] = n0;
+            c2[b] = n2;
+        }
+        k0 += kPhiloxW0;
+        k1 += kPhiloxW1;
+    }
+
+    for (Int_t b = 0; b < kBlocks; b++)
+    {
+        uniform[2 * b] = ToUniform(c1[b], c0[b]);
+        uniform[2 * b + 1] = ToUniform(c3[b], c2[b]);
+    }
+}
+
+void R3BGTPCRandom::ElectronGaus(UInt_t electron, UInt_t step, Double_t* out) const
+{
+    // Two blocks of the counter space of the electron, each giving a pair of
+    // Box-Muller deviates
+    ULong64_t block = kElectronBlocks + ((ULong64_t)electron << 32) + 2 * (ULong64_t)step;
+    for (Int_t b = 0; b < 2; b++)
+    {
+        uint32_t c[4] = { (uint32_t)(block + b), (uint32_t)((block + b) >> 32), fEvent, fStream };
+        Philox(c, fKey[0], fKey[1]);
+        Double_t radius = std::sqrt(-2. * std::log(ToUniform(c[1], c[0])));
+        Double_t phi = kTwoPi * ToUniform(c[3], c[2]);
+        out[2 * b] = radius * std::cos(phi);
+        out[2 * b + 1] = radius * std::sin(phi);
+    }
+}
+
+void R3BGTPCRandom::Fill()
+{
+    Generate(fBlock, fNormal);
+    fBlock += kBlocks;
+
+    // Box-Muller: the two uniforms of a block give two independent deviates
+    for (Int_t b = 0; b < kBlocks; b++)
+    {
+        Double_t radius = std::sqrt(-2. * std::log(fNormal[2 * b]));
+        Double_t phi = kTwoPi * fNormal[2 * b + 1];
+        fNormal[2 * b] = radius * std::cos(phi);
+        fNormal[2 * b + 1] = radius * std::sin(phi);
+    }
+    fNext = 0;
+}
+
+void R3BGTPCRandom::FillUniform()
+{
+    Generate(fUniformBlock, fUniform);
+    fUniformBlock += kBlocks;
+    fNextUniform = 0;
+}
+
+Int_t R3BGTPCRandom::Poisson(Double_t mean)
+{
+    if (mean <= 0.)
+        return 0;
+    if (mean < kPoissonSmallMean)
+    {
+        Double_t limit = std::exp(-mean);
+        Double_t product = Rndm();
+        Int_t k = 0;
+        while (product > limit)
+        {
+            product *= Rndm();
+            k++;
+        }
+        return k;
+    }
+
+    // W. Hormann, The transformed rejection method for generating Poisson
+    // random variables, Insurance: Mathematics and Economics 12 (1993) 39
+    Double_t sqrtMean = std::sqrt(mean);
+    Double_t logMean = std::log(mean);
+    Double_t b = 0.931 + 2.53 * sqrtMean;
+    Double_t a = -0.059 + 0.02483 * b;
+    Double_t invAlpha = 1.1239 + 1.1328 / (b - 3.4);
+    Double_t vr = 0.9277 - 3.6224 / (b - 2.);
+    while (true)
+    {
+        Double_t u = Rndm() - 0.5;
+        Double_t v = Rndm();
+        Double_t us = 0.5 - std::fabs(u);
+        Double_t k = std::floor((2. * a / us + b) * u + mean + 0.43);
+        if (us >= 0.07 && v <= vr)
+            return k;
+        if (k < 0. || (us < 0.013 && v > us))
+            continue;
+        if (std::log(v * invAlpha / (a / (us * us) + b)) <= -mean + k * logMean - std::lgamma(k + 1.))
+            return k;
+    }
+}
+
+Double_t R3BGTPCRandom::Gamma(Double_t shape)
+{
+    if (shape <= 0.)
+        return 0.;
+    if (shape < 1.) // Gamma(a) = Gamma(a+1) * U^(1/a)
+        return Gamma(shape + 1.) * std::pow(Rndm(), 1. / shape);
+
+    // G. Marsaglia and W. W. Tsang, A simple method for generating gamma
+    // variables, ACM Transactions on Mathematical Software 26 (2000) 363
+    Double_t d = shape - 1. / 3.;
+    Double_t c = 1. / std::sqrt(9. * d);
+    while (true)
+    {
+        Double_t x, v;
+        do
+        {
+            x = Gaus();
+            v = 1. + c * x;
+        } while (v <= 0.);
+        v = v * v * v;
+        Double_t u = Rndm();
+        if (u < 1. - 0.0331 * x * x * x * x)
+            return d * v;
+        if (std::log(u) < 0.5 * x * x + d * (1. - v + std::log(v)))
+            return d * v;
+    }
+}
+
+ULong64_t R3BGTPCRandom::MakeRunSeed(ULong64_t seed)
+{
+    if (seed != 0)
+        return seed;
+    return ((ULong64_t)gRandom->Integer(kMaxUInt) << 32) | gRandom->Integer(kMaxUInt);
+}
@@ -0,0 +1,128 @@
+/******************************************************************************
+ *   Copyright (C) 2018 GSI Helmholtzzentrum für Schwerionenforschung GmbH    *
+ *   Copyright (C) 2018-2025 Members of R3B Collaboration                     *
+ *                                                                            *
+ *             This software is distributed under the terms of the            *
+ *                 GNU Lesser General Public Licence (LGPL) version 3,        *
+ *                    copied verbatim in the file "LICENSE".                  *
+ *                                                                            *
+ * In applying this license GSI does not waive the privileges and immunities  *
+ * granted to it by virtue of its status as an Intergovernmental Organization *
+ * or submit itself to any jurisdiction.                                      *
+ ******************************************************************************/
+
+/**  R3BGTPCRandom.h
+ * Random numbers for the digitization tasks: normal deviates generated in
+ * bulk from a counter-based engine
+ **/
+
+#pragma once
+
+#include "Rtypes.h"
+
+/**
+ * GTPC random number stream
+ *
+ * The engine is Philox4x32-10: each 128-bit counter is encrypted with the
+ * 64-bit seed as key into 128 random bits, with no state other than the
+ * counter. A stream is the counter space of one (seed, event, stream) tuple,
+ * so streams can be created for any event or point in any order and thread
+ * and always give the same numbers.
+ *
+ * Normal deviates are produced kBufferSize at a time, with a Box-Muller
+ * transform of pairs of 52-bit uniforms, in plain loops over the buffer the
+ * compiler can vectorize, and handed out one by one by the inline Gaus().
+ * Uniform and Poisson deviates come from the upper half of the block
+ * counters, so drawing them does not change the normal deviates.
+ * A stream is cheap to create but is meant to be reused through SetSeed();
+ * it is not thread safe, each thread keeps its own.
+ *
+ * The digitization tasks key their streams by (run seed, event ID, point
+ * index), and the draws not tied to a point in kEventStream. The diffusion
+ * of the drift steps is drawn with ElectronGaus, keyed in addition by the
+ * electron index and step, so it does not depend on how the electrons are
+ * packed by R3BGTPCDriftStepper. The output of an event is then the same
+ * whatever the order, thread, job or instruction set it is processed with.
+ */
+
+class R3BGTPCRandom
+{
+  public:
+    static constexpr Int_t kBufferSize = 256;
+    static constexpr UInt_t kEventStream = 0xFFFFFFFF; //!< Stream of the draws of an event not tied to a point
+
+    /** Constructor
+     *@param seed     Seed of the run or event, key of the engine
+     *@param event    Event identifier
+     *@param stream   Stream inside the event, e.g. point index
+     **/
+    explicit R3BGTPCRandom(ULong64_t seed = 0, UInt_t event = 0, UInt_t stream = 0);
+
+    /** Destructor **/
+    ~R3BGTPCRandom() = default;
+
+    /** Restart at the beginning of the stream (seed, event, stream) **/
+    void SetSeed(ULong64_t seed, UInt_t event = 0, UInt_t stream = 0);
+
+    /** Normal deviate of mean 0 and sigma 1 **/
+    Double_t Gaus()
+    {
+        if (fNext == kBufferSize)
+            Fill();
+        return fNormal[fNext++];
+    }
+
+    /** Normal deviate, same arguments as TRandom::Gaus **/
+    Double_t Gaus(Double_t mean, Double_t sigma) { return mean + sigma * Gaus(); }
+
+    /** Fill n normal deviates of mean 0 and sigma 1 **/
+    void FillGaus(Double_t* out, Int_t n);
+
+    /** Four normal deviates of mean 0 and sigma 1 for a step of an electron,
+     ** from the part of the stream of that electron: the same for a given
+     ** (electron, step) whatever is drawn before. Does not change the stream **/
+    void ElectronGaus(UInt_t electron, UInt_t step, Double_t* out) const;
+
+    /** Uniform deviate in (0,1), from its own part of the stream **/
+    Double_t Rndm()
+    {
+        if (fNextUniform == kBufferSize)
+            FillUniform();
+        return fUniform[fNextUniform++];
+    }
+
+    /** Poisson deviate: multiplication of uniforms for small mean, transformed
+     ** rejection (Hormann's PTRS) above kPoissonSmallMean **/
+    Int_t Poisson(Double_t mean);
+
+    static constexpr Double_t kPoissonSmallMean = 10.;
+
+    /** Gamma deviate of unit scale (Marsaglia-Tsang), e.g. a Polya gain of
+     ** mean G and parameter theta is G/(theta+1)*Gamma(theta+1) **/
+    Double_t Gamma(Double_t shape);
+
+    /** Seed of a run: seed itself, or if it is 0 one drawn from gRandom. The
+     ** tasks call it once in Init, so jobs of the same run must give the same
+     ** seed (or seed gRandom the same way) to get the same output **/
+    static ULong64_t MakeRunSeed(ULong64_t seed);
+
+  private:
+    UInt_t fKey[2];                             //!< Seed of the stream
+    UInt_t fEvent;                              //!< Event of the stream (third counter word)
+    UInt_t fStream;                             //!< Stream in the event (fourth counter word)
+    ULong64_t fBlock;                           //!< Next block of the stream (first two counter words)
+    Int_t fNext;                                //!< Next deviate to hand out from fNormal
+    ULong64_t fUniformBlock;                    //!< Next block of the uniform part of the stream
+    Int_t fNextUniform;                         //!< Next deviate to hand out from fUniform
+    alignas(64) Double_t fNormal[kBufferSize];  //!< Normal deviates
+    alignas(64) Double_t fUniform[kBufferSize]; //!< Uniform deviates
+
+    /** kBufferSize uniforms from the kBufferSize/2 blocks starting at block **/
+    void Generate(ULong64_t block, Double_t* uniform) const;
+
+    /** Refill fNormal with the next kBufferSize/2 blocks of the stream **/
+    void Fill();
+
+    /** Refill fUniform with the next kBufferSize/2 blocks of the uniform part **/
+    void FillUniform();
+};
@@ -0,0 +1,85 @@
+/******************************************************************************
+ *   Copyright (C) 2018 GSI Helmholtzzentrum für Schwerionenforschung GmbH    *
+ *   Copyright (C) 2018-2025 Members of R3B Collaboration                     *
+ *                                                                            *
+ *             This software is distributed under the terms of the            *
+ *                 GNU Lesser General Public Licence (LGPL) version 3,        *
+ *                    copied verbatim in the file "LICENSE".                  *
+ *                                                                            *
+ * In applying this license GSI does not waive the privileges and immunities  *
+ * granted to it by virtue of its status as an Intergovernmental Organization *
+ * or submit itself to any jurisdiction.                                      *
+ ******************************************************************************/
+
+
+#include "R3BGTPCThreadPool.h"
+
+R3BGTPCThreadPool::R3BGTPCThreadPool(Int_t nWorkers)
+    : fJob(nullptr)
+    , fNJobs(0)
+    , fGeneration(0)
+    , fPending(0)
+    , fStop(kFALSE)
+{
+    fWorkers.reserve(nWorkers);
+    for (Int_t w = 0; w < nWorkers; w++)
+        fWorkers.emplace_back(&R3BGTPCThreadPool::Work, this, w);
+}
+
+R3BGTPCThreadPool::~R3BGTPCThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(fMutex);
+        fStop = kTRUE;
+    }
+    fStart.notify_all();
+    for (auto& worker : fWorkers)
+        worker.join();
+}
+
+void R3BGTPCThreadPool::Run(Int_t n, const std::function<void(Int_t)>& job)
+{
+    if (n <= 1 || fWorkers.empty())
+    {
+        if (n > 0)
+            job(0);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(fMutex);
+        fJob = &job;
+        fNJobs = n;
+        fPending = fWorkers.size();
+        fGeneration++;
+    }
+    fStart.notify_all();
+
+    job(0);
+
+    std::unique_lock<std::mutex> lock(fMutex);
+    fDone.wait(lock, [this] { return fPending == 0; });
+    fJob = nullptr;
+}
+
+void R3BGTPCThreadPool::Work(Int_t w)
+{
+    ULong64_t generation = 0;
+    std::unique_lock<std::mutex> lock(fMutex);
+    while (true)
+    {
+        fStart.wait(lock, [&] { return fStop || fGeneration != generation; });
+        if (fStop)
+            return;
+        generation = fGeneration;
+        if (w + 1 < fNJobs)
+        {
+            const auto& job = *fJob;
+            lock.unlock();
+            job(w + 1);
+            lock.lock();
+        }
+        if (--fPending == 0)
+            fDone.notify_one();
+    }
+}
@@ -0,0 +1,70 @@
+/******************************************************************************
+ *   Copyright (C) 2018 GSI Helmholtzzentrum für Schwerionenforschung GmbH    *
+ *   Copyright (C) 2018-2025 Members of R3B Collaboration                     *
+ *                                                                            *
+ *             This software is distributed under the terms of the            *
+ *                 GNU Lesser General Public Licence (LGPL) version 3,        *
+ *                    copied verbatim in the file "LICENSE".                  *
+ *                                                                            *
+ * In applying this license GSI does not waive the privileges and immunities  *
+ * granted to it by virtue of its status as an Intergovernmental Organization *
+ * or submit itself to any jurisdiction.                                      *
+ ******************************************************************************/
+
+
+/**  R3BGTPCThreadPool.h
+ * Worker threads started once and given the parts of a parallel loop, event
+ * after event
+ **/
+
+#pragma once
+
+#include "Rtypes.h"
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * GTPC thread pool
+ *
+ * The workers are started by the constructor and sleep between the calls to
+ * Run(), so the work of every event can be split among them without creating
+ * threads per event. Run() is meant to be called from one thread at a time,
+ * e.g. the event stream owning the pool.
+ */
+
+class R3BGTPCThreadPool
+{
+  public:
+    /** Constructor, starting nWorkers threads **/
+    explicit R3BGTPCThreadPool(Int_t nWorkers);
+
+    /** Destructor, stopping and joining the workers **/
+    ~R3BGTPCThreadPool();
+
+    R3BGTPCThreadPool(const R3BGTPCThreadPool&) = delete;
+    R3BGTPCThreadPool& operator=(const R3BGTPCThreadPool&) = delete;
+
+    Int_t GetNumberOfWorkers() const { return fWorkers.size(); }
+
+    /** Run job(0) on the calling thread and job(1) to job(n-1) on the workers,
+     ** returning once all of them are done. n is at most GetNumberOfWorkers()+1 **/
+    void Run(Int_t n, const std::function<void(Int_t)>& job);
+
+  private:
+    std::vector<std::thread> fWorkers;      //!< Worker threads
+    std::mutex fMutex;                      //!< Guards the members below
+    std::condition_variable fStart;         //!< Signalled when a Run() starts or the pool stops
+    std::condition_variable fDone;          //!< Signalled when the last worker is done
+    const std::function<void(Int_t)>* fJob; //!< Job of the current Run()
+    Int_t fNJobs;                           //!< Parts of the current Run()
+    ULong64_t fGeneration;                  //!< Number of Run() calls so far
+    Int_t fPending;                         //!< Workers not done with the current Run()
+    Bool_t fStop;                           //!< Set by the destructor
+
+    /** Loop of worker w, running part w+1 of each Run() **/
+    void Work(Int_t w);
+};
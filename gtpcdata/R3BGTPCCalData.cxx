@@ -16,13 +16,69 @@
 R3BGTPCCalData::R3BGTPCCalData()
     : fPadId(0)
     , fADC(0)
+    , fNBuckets(0)
 {
 }
 
-R3BGTPCCalData::R3BGTPCCalData(UShort_t padId, std::vector<UShort_t> adc)
+R3BGTPCCalData::R3BGTPCCalData(UShort_t padId, std::vector<UShort_t> adc, Bool_t zeroSuppress)
     : fPadId(padId)
     , fADC(adc)
+    , fNBuckets(0)
 {
+    if (zeroSuppress && !adc.empty() && R3BGTPCSamples::IsWorthCompressing(adc))
+    {
+        R3BGTPCSamples::Compress(adc, fBuckets, fADC);
+        fNBuckets = adc.size();
+    }
+}
+
+std::vector<UShort_t> R3BGTPCCalData::GetADC() const
+{
+    std::vector<UShort_t> adc;
+    GetADC(adc);
+    return adc;
+}
+
+void R3BGTPCCalData::GetADC(std::vector<UShort_t>& adc) const
+{
+    if (IsZeroSuppressed())
+        R3BGTPCSamples::Expand(fNBuckets, fBuckets, fADC, adc);
+    else
+        adc.assign(fADC.begin(), fADC.end());
+}
+
+void R3BGTPCCalData::SetADC(Double_t time, UShort_t counts)
+{
+    if (IsZeroSuppressed())
+    { // back to all the time buckets
+        fADC = GetADC();
+        fBuckets.clear();
+        fNBuckets = 0;
+    }
+    fADC.at(time) += counts;
+}
+
+void R3BGTPCCalData::Set(UShort_t padId, const std::vector<UShort_t>& adc, Bool_t zeroSuppress)
+{
+    fPadId = padId;
+    if (zeroSuppress && !adc.empty() && R3BGTPCSamples::IsWorthCompressing(adc))
+    {
+        R3BGTPCSamples::Compress(adc, fBuckets, fADC);
+        fNBuckets = adc.size();
+    }
+    else
+    {
+        fADC.assign(adc.begin(), adc.end());
+        fBuckets.clear();
+        fNBuckets = 0;
+    }
+}
+
+void R3BGTPCCalData::Clear(Option_t*)
+{
+    std::vector<UShort_t>().swap(fADC);
+    std::vector<UShort_t>().swap(fBuckets);
+    fNBuckets = 0;
 }
 
 ClassImp(R3BGTPCCalData);
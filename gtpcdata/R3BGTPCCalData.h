@@ -14,6 +14,7 @@
 #ifndef R3BGTPCCALDATA_H
 #define R3BGTPCCALDATA_H
 
+#include "R3BGTPCSamples.h"
 #include "TObject.h"
 #include <stdint.h>
 
@@ -27,26 +28,40 @@ class R3BGTPCCalData : public TObject
     /** Standard Constructor
      *@param padId               Crystal unique identifier
      *@param adc                 Calibrated adc energies
+     *@param zeroSuppress        Store only the non-zero time buckets, if smaller
      **/
-    R3BGTPCCalData(UShort_t padId, std::vector<UShort_t> adc);
+    R3BGTPCCalData(UShort_t padId, std::vector<UShort_t> adc, Bool_t zeroSuppress = kFALSE);
 
     // Destructor
     virtual ~R3BGTPCCalData() {}
 
     // Getters
     inline const UShort_t& GetPadId() const { return fPadId; }
-    inline const std::vector<UShort_t>& GetADC() const { return fADC; }
+    // All the time buckets, expanded if zero suppressed
+    std::vector<UShort_t> GetADC() const;
+    // All the time buckets into adc, reusing its memory
+    void GetADC(std::vector<UShort_t>& adc) const;
+    // Non-zero time buckets, without expanding
+    R3BGTPCSamples GetSamples() const { return R3BGTPCSamples(fADC, fBuckets, IsZeroSuppressed()); }
+    inline Bool_t IsZeroSuppressed() const { return fNBuckets > 0; }
 
     // Setter
     void SetPadId(UShort_t padId) { fPadId = padId; }
-    void SetADC(Double_t time) { fADC.at(time)++; }
+    void SetADC(Double_t time) { SetADC(time, 1); }
+    void SetADC(Double_t time, UShort_t counts);
+    // All the data, reusing the memory of the object (as with TClonesArray::ConstructedAt)
+    void Set(UShort_t padId, const std::vector<UShort_t>& adc, Bool_t zeroSuppress = kFALSE);
+
+    void Clear(Option_t* option = "");
 
   protected:
-    UShort_t fPadId;            // Pad unique identifier
-    std::vector<UShort_t> fADC; // ADC measurements, variable time bucket
+    UShort_t fPadId;                // Pad unique identifier
+    std::vector<UShort_t> fADC;     // ADC measurements, variable time bucket (non-zero ones if suppressed)
+    std::vector<UShort_t> fBuckets; // Time buckets of fADC if zero suppressed, empty otherwise
+    UShort_t fNBuckets;             // Time buckets of the measurement if zero suppressed, 0 otherwise
 
   public:
-    ClassDef(R3BGTPCCalData, 1)
+    ClassDef(R3BGTPCCalData, 2)
 };
 
 #endif
@@ -0,0 +1,119 @@
+/******************************************************************************
+ *   Copyright (C) 2025 GSI Helmholtzzentrum für Schwerionenforschung GmbH    *
+ *   Copyright (C) 2025 Members of R3B Collaboration                          *
+ *                                                                            *
+ *             This software is distributed under the terms of the            *
+ *                 GNU General Public Licence (GPL) version 3,                *
+ *                    copied verbatim in the file "LICENSE".                  *
+ *                                                                            *
+ * In applying this license GSI does not waive the privileges and immunities  *
+ * granted to it by virtue of its status as an Intergovernmental Organization *
+ * or submit itself to any jurisdiction.                                      *
+ ******************************************************************************/
+
+#include "R3BGTPCCompactPoint.h"
+#include "R3BGTPCPointNames.h"
+#include "TClonesArray.h"
+
+R3BGTPCCompactPoint::R3BGTPCCompactPoint()
+    : fTrackID(-1)
+    , fDetectorID(-1)
+    , fEventID(0)
+    , fX(0.)
+    , fY(0.)
+    , fZ(0.)
+    , fPx(0.)
+    , fPy(0.)
+    , fPz(0.)
+    , fTime(0.)
+    , fLength(0.)
+    , fELoss(0.)
+    , fParentTrackID(0)
+    , fPrimaryParticleID(0)
+    , fTrackStatus(0)
+    , fPDGCode(0)
+    , fModuleID(0)
+    , fDetCopyID(0)
+    , fParticleID(0)
+    , fVolumeID(0)
+    , fProcessID(0)
+    , fCharge(0.)
+    , fMass(0.)
+    , fKineticEnergy(0.)
+    , fTrackStep(0.)
+    , fIsAccepted(kFALSE)
+{
+}
+
+R3BGTPCCompactPoint::R3BGTPCCompactPoint(const R3BGTPCPoint& point, R3BGTPCPointNames& names)
+    : fTrackID(point.GetTrackID())
+    , fDetectorID(point.GetDetectorID())
+    , fEventID(point.GetEventID())
+    , fX(point.GetX())
+    , fY(point.GetY())
+    , fZ(point.GetZ())
+    , fPx(point.GetPx())
+    , fPy(point.GetPy())
+    , fPz(point.GetPz())
+    , fTime(point.GetTime())
+    , fLength(point.GetLength())
+    , fELoss(point.GetEnergyLoss())
+    , fParentTrackID(point.GetParentTrackID())
+    , fPrimaryParticleID(point.GetPrimaryParticleID())
+    , fTrackStatus(point.GetTrackStatus())
+    , fPDGCode(point.GetPDGCode())
+    , fModuleID(point.GetModuleID())
+    , fDetCopyID(point.GetDetCopyID())
+    , fParticleID(names.GetParticleID(point.GetParticleName()))
+    , fVolumeID(names.GetVolumeID(point.GetVolName()))
+    , fProcessID(names.GetProcessID(point.GetProcessName()))
+    , fCharge(point.GetCharge())
+    , fMass(point.GetMass())
+    , fKineticEnergy(point.GetKineticEnergy())
+    , fTrackStep(point.GetTrackStep())
+    , fIsAccepted(point.IsAccepted())
+{
+}
+
+R3BGTPCPoint R3BGTPCCompactPoint::GetPoint(const R3BGTPCPointNames* names) const
+{
+    R3BGTPCPoint point(fTrackID,
+                       fDetectorID,
+                       TVector3(fX, fY, fZ),
+                       TVector3(fPx, fPy, fPz),
+                       fTime,
+                       fLength,
+                       fELoss,
+                       fEventID,
+                       fParentTrackID,
+                       fPrimaryParticleID,
+                       fTrackStatus,
+                       fPDGCode,
+                       fModuleID,
+                       fDetCopyID,
+                       names ? names->GetParticleName(fParticleID) : TString(),
+                       names ? names->GetVolumeName(fVolumeID) : TString(),
+                       names ? names->GetProcessName(fProcessID) : TString(),
+                       fCharge,
+                       fMass,
+                       fKineticEnergy,
+                       fTrackStep,
+                       fIsAccepted);
+    // the constructor of R3BGTPCPoint takes the primary from the parent
+    point.SetPrimaryParticleID(fPrimaryParticleID);
+    return point;
+}
+
+void R3BGTPCCompactPoint::Expand(const TClonesArray* compact, TClonesArray* points, const R3BGTPCPointNames* names)
+{
+    // R3BGTPCPoint has TString members, the old points must be destructed
+    points->Delete();
+    Int_t n = compact->GetEntriesFast();
+    for (Int_t i = 0; i < n; i++)
+    {
+        auto cPoint = static_cast<const R3BGTPCCompactPoint*>(compact->At(i));
+        new ((*points)[i]) R3BGTPCPoint(cPoint->GetPoint(names));
+    }
+}
+
+ClassImp(R3BGTPCCompactPoint)
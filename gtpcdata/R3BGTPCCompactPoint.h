@@ -0,0 +1,106 @@
+/******************************************************************************
+ *   Copyright (C) 2025 GSI Helmholtzzentrum für Schwerionenforschung GmbH    *
+ *   Copyright (C) 2025 Members of R3B Collaboration                          *
+ *                                                                            *
+ *             This software is distributed under the terms of the            *
+ *                 GNU General Public Licence (GPL) version 3,                *
+ *                    copied verbatim in the file "LICENSE".                  *
+ *                                                                            *
+ * In applying this license GSI does not waive the privileges and immunities  *
+ * granted to it by virtue of its status as an Intergovernmental Organization *
+ * or submit itself to any jurisdiction.                                      *
+ ******************************************************************************/
+
+/**  R3BGTPCCompactPoint.h
+ * Compact storage of R3BGTPCPoint: single precision kinematics and the
+ * particle, volume and process names replaced by identifiers of a
+ * R3BGTPCPointNames dictionary
+ **/
+
+#ifndef R3BGTPCCOMPACTPOINT_H
+#define R3BGTPCCOMPACTPOINT_H
+
+#include "R3BGTPCPoint.h"
+#include "TObject.h"
+
+class R3BGTPCPointNames;
+class TClonesArray;
+
+class R3BGTPCCompactPoint : public TObject
+{
+  public:
+    /** Default constructor **/
+    R3BGTPCCompactPoint();
+
+    /** Constructor from a point
+     *@param point  Point to store
+     *@param names  Dictionary the names of the point are added to
+     **/
+    R3BGTPCCompactPoint(const R3BGTPCPoint& point, R3BGTPCPointNames& names);
+
+    /** Destructor **/
+    virtual ~R3BGTPCCompactPoint() = default;
+
+    /** Full point; the names are left empty without dictionary **/
+    R3BGTPCPoint GetPoint(const R3BGTPCPointNames* names = nullptr) const;
+
+    /** Fill points with the expansion of all the compact points **/
+    static void Expand(const TClonesArray* compact, TClonesArray* points, const R3BGTPCPointNames* names = nullptr);
+
+    /** Accessors **/
+    Int_t GetTrackID() const { return fTrackID; }
+    Int_t GetDetectorID() const { return fDetectorID; }
+    UInt_t GetEventID() const { return fEventID; }
+    Float_t GetX() const { return fX; }
+    Float_t GetY() const { return fY; }
+    Float_t GetZ() const { return fZ; }
+    Float_t GetPx() const { return fPx; }
+    Float_t GetPy() const { return fPy; }
+    Float_t GetPz() const { return fPz; }
+    Float_t GetTime() const { return fTime; }
+    Float_t GetLength() const { return fLength; }
+    Float_t GetEnergyLoss() const { return fELoss; }
+    Int_t GetParentTrackID() const { return fParentTrackID; }
+    Int_t GetPrimaryParticleID() const { return fPrimaryParticleID; }
+    Int_t GetTrackStatus() const { return fTrackStatus; }
+    Int_t GetPDGCode() const { return fPDGCode; }
+    Int_t GetModuleID() const { return fModuleID; }
+    Int_t GetDetCopyID() const { return fDetCopyID; }
+    UShort_t GetParticleID() const { return fParticleID; }
+    UShort_t GetVolumeID() const { return fVolumeID; }
+    UShort_t GetProcessID() const { return fProcessID; }
+    Float_t GetCharge() const { return fCharge; }
+    Float_t GetMass() const { return fMass; }
+    Float_t GetKineticEnergy() const { return fKineticEnergy; }
+    Float_t GetTrackStep() const { return fTrackStep; }
+    Bool_t IsAccepted() const { return fIsAccepted; }
+
+  private:
+    Int_t fTrackID;           // Index of MCTrack
+    Int_t fDetectorID;        // Detector ID
+    UInt_t fEventID;          // MC event id
+    Float_t fX, fY, fZ;       // Position [cm]
+    Float_t fPx, fPy, fPz;    // Momentum [GeV]
+    Float_t fTime;            // Time since event start [ns]
+    Float_t fLength;          // Track length since creation [cm]
+    Float_t fELoss;           // Energy deposit [GeV]
+    Int_t fParentTrackID;     // Parent track ID
+    Int_t fPrimaryParticleID; // Primary Particle ID
+    Int_t fTrackStatus;       // Status of the track
+    Int_t fPDGCode;           // PDG of the particle transported
+    Int_t fModuleID;          // Module ID
+    Int_t fDetCopyID;         // Detector Copy ID
+    UShort_t fParticleID;     // Particle name in R3BGTPCPointNames
+    UShort_t fVolumeID;       // Volume name in R3BGTPCPointNames
+    UShort_t fProcessID;      // Process name in R3BGTPCPointNames
+    Float_t fCharge;          // Charge of the track
+    Float_t fMass;            // Mass of the track
+    Float_t fKineticEnergy;   // Kinetic energy of the track
+    Float_t fTrackStep;       // Length of the step [cm]
+    Bool_t fIsAccepted;       // Accepted flag of R3BGTPCPoint
+
+  public:
+    ClassDef(R3BGTPCCompactPoint, 1)
+};
+
+#endif
@@ -7,10 +7,17 @@
 #pragma link off all functions;
 
 #pragma link C++ class R3BGTPCPoint + ;
+#pragma link C++ class R3BGTPCCompactPoint + ;
+#pragma link C++ class R3BGTPCPointNames + ;
 #pragma link C++ class R3BGTPCProjPoint + ;
 #pragma link C++ class R3BGTPCMappedData + ;
 #pragma link C++ class R3BGTPCCalData + ;
 #pragma link C++ class R3BGTPCHitData + ;
 #pragma link C++ class R3BGTPCHitClusterData + ;
 #pragma link C++ class R3BGTPCTrackData + ;
+
+// Version 1 of R3BGTPCProjPoint kept its time distribution in a TH1S
+#pragma read sourceClass = "R3BGTPCProjPoint" version = "[1]" targetClass = "R3BGTPCProjPoint" \
+    source = "TH1S* fTimeDistr" target = "fTimeBins, fTimeContents, fTimeSumW, fTimeSumWT, fTimeSumWT2" \
+    include = "TH1S.h" code = "{ newObj->SetTimeDistr(onfile.fTimeDistr); delete onfile.fTimeDistr; }"
 #endif
@@ -16,6 +16,7 @@
 R3BGTPCMappedData::R3BGTPCMappedData()
     : fPadId(0)
     , fADC(0)
+    , fNBuckets(0)
     , fIsValid(0)
     , fIsPedestalSubtracted(0)
 {
@@ -24,12 +25,41 @@ R3BGTPCMappedData::R3BGTPCMappedData()
 R3BGTPCMappedData::R3BGTPCMappedData(UShort_t padId,
                                      std::vector<UShort_t> adc,
                                      Bool_t isValid,
-                                     Bool_t isPedestalSubtracted)
+                                     Bool_t isPedestalSubtracted,
+                                     Bool_t zeroSuppress)
     : fPadId(padId)
     , fADC(adc)
+    , fNBuckets(0)
     , fIsValid(isValid)
     , fIsPedestalSubtracted(isPedestalSubtracted)
 {
+    if (zeroSuppress && !adc.empty() && R3BGTPCSamples::IsWorthCompressing(adc))
+    {
+        R3BGTPCSamples::Compress(adc, fBuckets, fADC);
+        fNBuckets = adc.size();
+    }
+}
+
+std::vector<UShort_t> R3BGTPCMappedData::GetADC() const
+{
+    std::vector<UShort_t> adc;
+    GetADC(adc);
+    return adc;
+}
+
+void R3BGTPCMappedData::GetADC(std::vector<UShort_t>& adc) const
+{
+    if (IsZeroSuppressed())
+        R3BGTPCSamples::Expand(fNBuckets, fBuckets, fADC, adc);
+    else
+        adc.assign(fADC.begin(), fADC.end());
+}
+
+void R3BGTPCMappedData::Clear(Option_t*)
+{
+    std::vector<UShort_t>().swap(fADC);
+    std::vector<UShort_t>().swap(fBuckets);
+    fNBuckets = 0;
 }
 
 ClassImp(R3BGTPCMappedData);
@@ -14,6 +14,7 @@
 #ifndef R3BGTPCMAPPEDDATA_H
 #define R3BGTPCMAPPEDDATA_H
 
+#include "R3BGTPCSamples.h"
 #include "TObject.h"
 #include <stdint.h>
 
@@ -29,27 +30,44 @@ class R3BGTPCMappedData : public TObject
      *@param adc                  Vector of ADC measurements, variable size
      *@param isValid              Data validity check
      *@param isPedestalSubtracted Pedestal subtraction flag
+     *@param zeroSuppress         Store only the non-zero time buckets, if smaller
      **/
-    R3BGTPCMappedData(UShort_t padId, std::vector<UShort_t> adc, Bool_t isValid, Bool_t isPedestalSubtracted);
+    R3BGTPCMappedData(UShort_t padId,
+                      std::vector<UShort_t> adc,
+                      Bool_t isValid,
+                      Bool_t isPedestalSubtracted,
+                      Bool_t zeroSuppress = kFALSE);
 
     // Destructor
     virtual ~R3BGTPCMappedData() {}
 
     // Getters
     inline const UShort_t& GetPadId() const { return fPadId; }
-    inline const std::vector<UShort_t>& GetADC() const { return fADC; }
+    // All the time buckets, expanded if zero suppressed
+    std::vector<UShort_t> GetADC() const;
+    // All the time buckets into adc, reusing its memory
+    void GetADC(std::vector<UShort_t>& adc) const;
+    // Number of time buckets of the measurement
+    inline Int_t GetNBuckets() const { return IsZeroSuppressed() ? fNBuckets : fADC.size(); }
+    // Non-zero time buckets, without expanding
+    R3BGTPCSamples GetSamples() const { return R3BGTPCSamples(fADC, fBuckets, IsZeroSuppressed()); }
+    inline Bool_t IsZeroSuppressed() const { return fNBuckets > 0; }
     inline const Bool_t& IsValid() const { return fIsValid; }
     inline const Bool_t& IsPedestalSubtracted() const { return fIsPedestalSubtracted; }
 
+    void Clear(Option_t* option = "");
+
   protected:
-    UShort_t fPadId;              // Pad unique identifier
-    std::vector<UShort_t> fADC;   // ADC measurements, variable time bucket
-    Bool_t fIsValid;              // Valid check NEEDED??
-    Bool_t fIsPedestalSubtracted; // Needed? REMOVE ME IF IT IS A CTE.
-                                  // CHARACTERISTIC OF DATA
+    UShort_t fPadId;                // Pad unique identifier
+    std::vector<UShort_t> fADC;     // ADC measurements, variable time bucket (non-zero ones if suppressed)
+    std::vector<UShort_t> fBuckets; // Time buckets of fADC if zero suppressed, empty otherwise
+    UShort_t fNBuckets;             // Time buckets of the measurement if zero suppressed, 0 otherwise
+    Bool_t fIsValid;                // Valid check NEEDED??
+    Bool_t fIsPedestalSubtracted;   // Needed? REMOVE ME IF IT IS A CTE.
+                                    // CHARACTERISTIC OF DATA
 
   public:
-    ClassDef(R3BGTPCMappedData, 1)
+    ClassDef(R3BGTPCMappedData, 2)
 };
 
 #endif
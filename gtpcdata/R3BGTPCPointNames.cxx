@@ -0,0 +1,58 @@
+/******************************************************************************
+ *   Copyright (C) 2025 GSI Helmholtzzentrum für Schwerionenforschung GmbH    *
+ *   Copyright (C) 2025 Members of R3B Collaboration                          *
+ *                                                                            *
+ *             This software is distributed under the terms of the            *
+ *                 GNU General Public Licence (GPL) version 3,                *
+ *                    copied verbatim in the file "LICENSE".                  *
+ *                                                                            *
+ * In applying this license GSI does not waive the privileges and immunities  *
+ * granted to it by virtue of its status as an Intergovernmental Organization *
+ * or submit itself to any jurisdiction.                                      *
+ ******************************************************************************/
+
+#include "R3BGTPCPointNames.h"
+
+#include "FairLogger.h"
+
+UShort_t R3BGTPCPointNames::GetID(const TString& name,
+                                  std::vector<std::string>& names,
+                                  std::map<std::string, UShort_t>& ids)
+{
+    // the lookup map is not stored, it is rebuilt after reading
+    if (ids.size() != names.size())
+    {
+        ids.clear();
+        for (size_t id = 0; id < names.size(); id++)
+            ids.emplace(names[id], id);
+    }
+    auto found = ids.find(name.Data());
+    if (found != ids.end())
+        return found->second;
+    if (names.size() >= kMaxUShort)
+    {
+        LOG(error) << "R3BGTPCPointNames: too many names, " << name << " is not stored";
+        return kMaxUShort;
+    }
+    UShort_t id = names.size();
+    names.emplace_back(name.Data());
+    ids.emplace(names.back(), id);
+    return id;
+}
+
+TString R3BGTPCPointNames::GetName(UShort_t id, const std::vector<std::string>& names)
+{
+    return id < names.size() ? TString(names[id].c_str()) : TString();
+}
+
+void R3BGTPCPointNames::Clear(Option_t*)
+{
+    fParticleNames.clear();
+    fVolumeNames.clear();
+    fProcessNames.clear();
+    fParticleIDs.clear();
+    fVolumeIDs.clear();
+    fProcessIDs.clear();
+}
+
+ClassImp(R3BGTPCPointNames)
@@ -0,0 +1,67 @@
+/******************************************************************************
+ *   Copyright (C) 2025 GSI Helmholtzzentrum für Schwerionenforschung GmbH    *
+ *   Copyright (C) 2025 Members of R3B Collaboration                          *
+ *                                                                            *
+ *             This software is distributed under the terms of the            *
+ *                 GNU General Public Licence (GPL) version 3,                *
+ *                    copied verbatim in the file "LICENSE".                  *
+ *                                                                            *
+ * In applying this license GSI does not waive the privileges and immunities  *
+ * granted to it by virtue of its status as an Intergovernmental Organization *
+ * or submit itself to any jurisdiction.                                      *
+ ******************************************************************************/
+
+/**  R3BGTPCPointNames.h
+ * Per run dictionary of the particle, volume and process names of the
+ * R3BGTPCCompactPoints, which keep only their identifiers
+ **/
+
+#ifndef R3BGTPCPOINTNAMES_H
+#define R3BGTPCPOINTNAMES_H
+
+#include "TObject.h"
+#include "TString.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+class R3BGTPCPointNames : public TObject
+{
+  public:
+    /** Default constructor **/
+    R3BGTPCPointNames() = default;
+
+    /** Destructor **/
+    virtual ~R3BGTPCPointNames() = default;
+
+    /** Identifier of a name, added to the dictionary if new **/
+    UShort_t GetParticleID(const TString& name) { return GetID(name, fParticleNames, fParticleIDs); }
+    UShort_t GetVolumeID(const TString& name) { return GetID(name, fVolumeNames, fVolumeIDs); }
+    UShort_t GetProcessID(const TString& name) { return GetID(name, fProcessNames, fProcessIDs); }
+
+    /** Name of an identifier, empty if unknown **/
+    TString GetParticleName(UShort_t id) const { return GetName(id, fParticleNames); }
+    TString GetVolumeName(UShort_t id) const { return GetName(id, fVolumeNames); }
+    TString GetProcessName(UShort_t id) const { return GetName(id, fProcessNames); }
+
+    void Clear(Option_t* option = "");
+
+  private:
+    std::vector<std::string> fParticleNames;      // Particle names, by identifier
+    std::vector<std::string> fVolumeNames;        // Volume names, by identifier
+    std::vector<std::string> fProcessNames;       // Process names, by identifier
+    std::map<std::string, UShort_t> fParticleIDs; //! Identifier of each particle name
+    std::map<std::string, UShort_t> fVolumeIDs;   //! Identifier of each volume name
+    std::map<std::string, UShort_t> fProcessIDs;  //! Identifier of each process name
+
+    static UShort_t GetID(const TString& name,
+                          std::vector<std::string>& names,
+                          std::map<std::string, UShort_t>& ids);
+    static TString GetName(UShort_t id, const std::vector<std::string>& names);
+
+  public:
+    ClassDef(R3BGTPCPointNames, 1)
+};
+
+#endif
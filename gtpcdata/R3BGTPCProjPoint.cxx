@@ -11,13 +11,19 @@
  * or submit itself to any jurisdiction.                                      *
  ******************************************************************************/
 #include "R3BGTPCProjPoint.h"
+#include "TH1S.h"
+
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 
 R3BGTPCProjPoint::R3BGTPCProjPoint()
 {
     fVirtualPadID = 0;
     fCharge = 0.;
-    fTimeDistr = NULL;
+    fTimeSumW = 0.;
+    fTimeSumWT = 0.;
+    fTimeSumWT2 = 0.;
     fPDGCode = 0;
     fMotherId = 0;
     fx0 = 0;
@@ -43,10 +49,9 @@ R3BGTPCProjPoint::R3BGTPCProjPoint(Int_t pad,
 {
     fVirtualPadID = pad;
     fCharge = charge;
-    char hname[255];
-    sprintf(hname, "event %i: pad %i", eventID, fVirtualPadID);
-    fTimeDistr = new TH1S(hname, hname, 400, 0, 40); // this is for microsec
-    // fTimeDistr = new TH1S(hname, hname, 400000, 0, 40000);//this is for nanosec
+    fTimeSumW = 0.;
+    fTimeSumWT = 0.;
+    fTimeSumWT2 = 0.;
     SetTimeDistr(time, charge);
     fPDGCode = PdgCode;
     fMotherId = MotherId;
@@ -58,16 +63,86 @@ R3BGTPCProjPoint::R3BGTPCProjPoint(Int_t pad,
     fpz0 = pz0;
 }
 
-R3BGTPCProjPoint::~R3BGTPCProjPoint()
+void R3BGTPCProjPoint::SetTimeDistr(Double_t time, Double_t weight)
+{
+    // bins as TH1::FindBin, statistics of the times in range as TH1::Fill
+    Int_t bin;
+    if (time < kTimeMin)
+        bin = 0;
+    else if (time >= kTimeMax)
+        bin = kNTimeBins + 1;
+    else
+    {
+        bin = 1 + (Int_t)((time - kTimeMin) * kNTimeBins / (kTimeMax - kTimeMin));
+        fTimeSumW += weight;
+        fTimeSumWT += weight * time;
+        fTimeSumWT2 += weight * time * time;
+    }
+
+    UInt_t content = std::lround(weight);
+    for (size_t i = 0; i < fTimeBins.size(); i++)
+        if (fTimeBins[i] == bin)
+        {
+            fTimeContents[i] += content;
+            return;
+        }
+    fTimeBins.push_back(bin);
+    fTimeContents.push_back(content);
+}
+
+void R3BGTPCProjPoint::SetTimeDistr(const TH1S* histo)
+{
+    Clear("");
+    if (!histo)
+        return;
+    for (Int_t bin = 0; bin <= histo->GetNbinsX() + 1; bin++)
+        if (histo->GetBinContent(bin) > 0)
+        {
+            fTimeBins.push_back(bin);
+            fTimeContents.push_back(histo->GetBinContent(bin));
+        }
+    Double_t stats[4];
+    histo->GetStats(stats);
+    fTimeSumW = stats[0];
+    fTimeSumWT = stats[2];
+    fTimeSumWT2 = stats[3];
+}
+
+UInt_t R3BGTPCProjPoint::GetTimeDistribution(Int_t bin) const
+{
+    for (size_t i = 0; i < fTimeBins.size(); i++)
+        if (fTimeBins[i] == bin)
+            return fTimeContents[i];
+    return 0;
+}
+
+Double_t R3BGTPCProjPoint::GetTimeRMS() const
+{
+    if (fTimeSumW <= 0)
+        return 0.;
+    Double_t mean = fTimeSumWT / fTimeSumW;
+    return std::sqrt(std::max(0., fTimeSumWT2 / fTimeSumW - mean * mean));
+}
+
+TH1S* R3BGTPCProjPoint::MakeTimeHistogram(const char* name) const
 {
-    if (fTimeDistr)
-        delete fTimeDistr;
+    auto histo = new TH1S(name, name, kNTimeBins, kTimeMin, kTimeMax);
+    for (size_t i = 0; i < fTimeBins.size(); i++)
+        histo->SetBinContent(fTimeBins[i], fTimeContents[i]);
+    // the sum of the squared weights is not kept, exact for unit weights
+    Double_t stats[4] = { fTimeSumW, fTimeSumW, fTimeSumWT, fTimeSumWT2 };
+    histo->PutStats(stats);
+    histo->SetEntries(fTimeSumW);
+    return histo;
 }
 
-void R3BGTPCProjPoint::Clear(Option_t* option)
+void R3BGTPCProjPoint::Clear(Option_t*)
 {
-    if (fTimeDistr)
-        delete fTimeDistr;
+    std::vector<UShort_t>().swap(fTimeBins);
+    std::vector<UInt_t>().swap(fTimeContents);
+    fTimeSumW = 0.;
+    fTimeSumWT = 0.;
+    fTimeSumWT2 = 0.;
 }
 
 ClassImp(R3BGTPCProjPoint)
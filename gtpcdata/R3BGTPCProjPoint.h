@@ -20,9 +20,12 @@
 #ifndef R3BGTPCPROJPOINT_H
 #define R3BGTPCPROJPOINT_H
 
-#include "TH1S.h"
 #include "TObject.h"
 
+#include <vector>
+
+class TH1S;
+
 class R3BGTPCProjPoint : public TObject
 {
   public:
@@ -44,13 +47,28 @@ class R3BGTPCProjPoint : public TObject
                      Double_t pz0);
 
     /** Destructor **/
-    ~R3BGTPCProjPoint();
+    ~R3BGTPCProjPoint() = default;
+
+    /** Binning of the time distribution [microsecond], as the former TH1S;
+     ** bin 0 is the underflow and kNTimeBins+1 the overflow **/
+    static constexpr Int_t kNTimeBins = 400;
+    static constexpr Double_t kTimeMin = 0.;
+    static constexpr Double_t kTimeMax = 40.;
 
     /** Accessors **/
     Int_t GetVirtualPadID() const { return fVirtualPadID; }
     Double_t GetCharge() const { return fCharge; }
-    TH1S* GetTimeDistribution() const { return fTimeDistr; }
-    Int_t GetTimeDistribution(Int_t bin) { return fTimeDistr->GetBinContent(bin); }
+    /** Content of a time bin, numbered as in a TH1 **/
+    UInt_t GetTimeDistribution(Int_t bin) const;
+    /** Weighted mean and RMS of the times inside [kTimeMin,kTimeMax), as
+     ** TH1::GetMean and TH1::GetRMS of the former histogram **/
+    Double_t GetTimeMean() const { return fTimeSumW > 0 ? fTimeSumWT / fTimeSumW : 0.; }
+    Double_t GetTimeRMS() const;
+    /** Filled bins of the time distribution and their contents **/
+    const std::vector<UShort_t>& GetTimeBins() const { return fTimeBins; }
+    const std::vector<UInt_t>& GetTimeContents() const { return fTimeContents; }
+    /** New histogram of the time distribution, owned by the caller **/
+    TH1S* MakeTimeHistogram(const char* name) const;
     // Vertex
     Int_t GetPDGCode() const { return fPDGCode; }
     Int_t GetMotherId() const { return fMotherId; }
@@ -65,18 +83,26 @@ class R3BGTPCProjPoint : public TObject
     void SetVirtualPadID(Int_t pad) { fVirtualPadID = pad; }
     void SetCharge(Double_t cha) { fCharge = cha; }
     void AddCharge() { fCharge = fCharge + 1; }
-    void SetTimeDistr(Double_t time, Double_t weight) { fTimeDistr->Fill(time, weight); }
+    void AddCharge(Double_t cha) { fCharge = fCharge + cha; }
+    void SetTimeDistr(Double_t time, Double_t weight);
+    /** Time distribution and statistics taken from a histogram with the
+     ** binning above, used to read the version 1 objects **/
+    void SetTimeDistr(const TH1S* histo);
 
     void Clear(Option_t* option);
 
   private:
-    Int_t fVirtualPadID; //!< Virtual pad Identifier
-    Double_t fCharge;    //!< Charge [electrons]
-    TH1S* fTimeDistr;    //!< Time distribution in the pad [0.1 microsecond/bin]
-                         // Vertex
+    Int_t fVirtualPadID;               //!< Virtual pad Identifier
+    Double_t fCharge;                  //!< Charge [electrons]
+    std::vector<UShort_t> fTimeBins;   //!< Filled bins of the time distribution [0.1 microsecond/bin]
+    std::vector<UInt_t> fTimeContents; //!< Content of each bin in fTimeBins
+    Double_t fTimeSumW;                //!< Sum of the weights of the times in range
+    Double_t fTimeSumWT;               //!< Sum of weight*time in range
+    Double_t fTimeSumWT2;              //!< Sum of weight*time^2 in range
+                                       // Vertex
     Int_t fPDGCode, fMotherId;
     Double_t fx0, fy0, fz0, fpx0, fpy0, fpz0;
-    ClassDef(R3BGTPCProjPoint, 1)
+    ClassDef(R3BGTPCProjPoint, 2)
 };
 
 #endif // R3BGTPCPROJPOINT_H
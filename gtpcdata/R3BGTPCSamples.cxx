@@ -0,0 +1,46 @@
+/******************************************************************************
+ *   Copyright (C) 2025 GSI Helmholtzzentrum für Schwerionenforschung GmbH    *
+ *   Copyright (C) 2025 Members of R3B Collaboration                          *
+ *                                                                            *
+ *             This software is distributed under the terms of the            *
+ *                 GNU General Public Licence (GPL) version 3,                *
+ *                    copied verbatim in the file "LICENSE".                  *
+ *                                                                            *
+ * In applying this license GSI does not waive the privileges and immunities  *
+ * granted to it by virtue of its status as an Intergovernmental Organization *
+ * or submit itself to any jurisdiction.                                      *
+ ******************************************************************************/
+
+#include "R3BGTPCSamples.h"
+
+#include <algorithm>
+
+void R3BGTPCSamples::Compress(const std::vector<UShort_t>& dense,
+                              std::vector<UShort_t>& buckets,
+                              std::vector<UShort_t>& adc)
+{
+    buckets.clear();
+    adc.clear();
+    for (size_t bucket = 0; bucket < dense.size(); bucket++)
+        if (dense[bucket] != 0)
+        {
+            buckets.push_back(bucket);
+            adc.push_back(dense[bucket]);
+        }
+}
+
+void R3BGTPCSamples::Expand(Int_t nBuckets,
+                            const std::vector<UShort_t>& buckets,
+                            const std::vector<UShort_t>& adc,
+                            std::vector<UShort_t>& dense)
+{
+    dense.assign(nBuckets, 0);
+    for (size_t i = 0; i < buckets.size(); i++)
+        dense[buckets[i]] = adc[i];
+}
+
+Bool_t R3BGTPCSamples::IsWorthCompressing(const std::vector<UShort_t>& dense)
+{
+    return 2 * std::count_if(dense.begin(), dense.end(), [](UShort_t value) { return value != 0; }) <
+           (Long64_t)dense.size();
+}
@@ -0,0 +1,109 @@
+/******************************************************************************
+ *   Copyright (C) 2025 GSI Helmholtzzentrum für Schwerionenforschung GmbH    *
+ *   Copyright (C) 2025 Members of R3B Collaboration                          *
+ *                                                                            *
+ *             This software is distributed under the terms of the            *
+ *                 GNU General Public Licence (GPL) version 3,                *
+ *                    copied verbatim in the file "LICENSE".                  *
+ *                                                                            *
+ * In applying this license GSI does not waive the privileges and immunities  *
+ * granted to it by virtue of its status as an Intergovernmental Organization *
+ * or submit itself to any jurisdiction.                                      *
+ ******************************************************************************/
+
+#ifndef R3BGTPCSAMPLES_H
+#define R3BGTPCSAMPLES_H
+
+#include "Rtypes.h"
+
+#include <vector>
+
+/**
+ * Time bucket samples of a pad, as stored in R3BGTPCMappedData and
+ * R3BGTPCCalData: either dense (one value per time bucket) or zero suppressed
+ * ((bucket, value) pairs of the non-zero buckets).
+ *
+ * The range iterates over the non-zero samples of both layouts alike. It
+ * points into the data object and is valid until the object is modified.
+ */
+
+class R3BGTPCSamples
+{
+  public:
+    struct Sample
+    {
+        UShort_t bucket; // Time bucket
+        UShort_t adc;    // Value
+    };
+
+    class Iterator
+    {
+      public:
+        Iterator(const UShort_t* buckets, const UShort_t* adc, Int_t index, Int_t size)
+            : fBuckets(buckets)
+            , fADC(adc)
+            , fIndex(index)
+            , fSize(size)
+        {
+            SkipZeros();
+        }
+
+        Sample operator*() const { return { fBuckets ? fBuckets[fIndex] : (UShort_t)fIndex, fADC[fIndex] }; }
+        Iterator& operator++()
+        {
+            ++fIndex;
+            SkipZeros();
+            return *this;
+        }
+        bool operator!=(const Iterator& other) const { return fIndex != other.fIndex; }
+
+      private:
+        const UShort_t* fBuckets; // Buckets of the values, nullptr if dense
+        const UShort_t* fADC;     // Values
+        Int_t fIndex;             // Present value
+        Int_t fSize;              // Number of values
+
+        void SkipZeros()
+        {
+            if (!fBuckets)
+                while (fIndex < fSize && fADC[fIndex] == 0)
+                    ++fIndex;
+        }
+    };
+
+    /** Range over the non-zero samples
+     *@param adc       Values, one per bucket if dense
+     *@param buckets   Buckets of the values if zero suppressed
+     *@param sparse    Zero suppressed layout
+     **/
+    R3BGTPCSamples(const std::vector<UShort_t>& adc, const std::vector<UShort_t>& buckets, Bool_t sparse)
+        : fBuckets(sparse ? buckets.data() : nullptr)
+        , fADC(adc.data())
+        , fSize(adc.size())
+    {
+    }
+
+    Iterator begin() const { return Iterator(fBuckets, fADC, 0, fSize); }
+    Iterator end() const { return Iterator(fBuckets, fADC, fSize, fSize); }
+
+    /** Non-zero buckets and values of a dense record **/
+    static void Compress(const std::vector<UShort_t>& dense,
+                         std::vector<UShort_t>& buckets,
+                         std::vector<UShort_t>& adc);
+
+    /** Dense record of nBuckets from its non-zero buckets and values **/
+    static void Expand(Int_t nBuckets,
+                       const std::vector<UShort_t>& buckets,
+                       const std::vector<UShort_t>& adc,
+                       std::vector<UShort_t>& dense);
+
+    /** True if the pairs of the non-zero buckets take less memory than dense **/
+    static Bool_t IsWorthCompressing(const std::vector<UShort_t>& dense);
+
+  private:
+    const UShort_t* fBuckets; // Buckets of the values, nullptr if dense
+    const UShort_t* fADC;     // Values
+    Int_t fSize;              // Number of values
+};
+
+#endif
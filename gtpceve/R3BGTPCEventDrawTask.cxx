@@ -1,8 +1,11 @@
 #include "R3BGTPCEventDrawTask.h"
 #include "R3BGTPCEventManager.h"
+#include "R3BGTPCGeoPar.h"
+#include "R3BGTPCPadGeometry.h"
 
 #include "FairLogger.h"
 #include "FairRootManager.h"
+#include "FairRuntimeDb.h"
 
 #include "TClonesArray.h"
 #include "TColor.h"
@@ -35,9 +38,13 @@ R3BGTPCEventDrawTask::R3BGTPCEventDrawTask()
     : fCvsPadPlane(0)
     , fPadPlane(0)
     , fMap(0)
+    , fGTPCGeoPar(0)
     , fHitSet(0)
     , fCvsPadWave(0)
     , fPadWave(0)
+    , fNColumns(0)
+    , fNRows(0)
+    , fPadSize(0.)
     , fHitCA(0)
     , fTrackCA(0)
 {
@@ -45,6 +52,20 @@ R3BGTPCEventDrawTask::R3BGTPCEventDrawTask()
 
 R3BGTPCEventDrawTask::~R3BGTPCEventDrawTask() {}
 
+void R3BGTPCEventDrawTask::SetParContainers()
+{
+    FairRuntimeDb* rtdb = FairRuntimeDb::instance();
+    if (!rtdb)
+    {
+        LOG(error) << "R3BGTPCEventDrawTask:: FairRuntimeDb not opened!";
+        return;
+    }
+
+    fGTPCGeoPar = (R3BGTPCGeoPar*)rtdb->getContainer("GTPCGeoPar");
+    if (!fGTPCGeoPar)
+        LOG(warn) << "R3BGTPCEventDrawTask::SetParContainers: No R3BGTPCGeoPar";
+}
+
 InitStatus R3BGTPCEventDrawTask::Init()
 {
 
@@ -56,6 +77,27 @@ InitStatus R3BGTPCEventDrawTask::Init()
 
     fMap = new R3BGTPCMap();
 
+    // Pad plane of the geometry parameters, unless set with SetPadPlane
+    if (fNColumns <= 0 || fNRows <= 0 || fPadSize <= 0.)
+    {
+        auto padGeometry = R3BGTPCPadGeometry::Instance(fGTPCGeoPar);
+        if (padGeometry)
+        {
+            fNColumns = padGeometry->GetNColumns();
+            fNRows = padGeometry->GetNRows();
+            fPadSize = padGeometry->GetPadSize();
+        }
+        else
+        {
+            LOG(warn) << "R3BGTPCEventDrawTask::Init: No R3BGTPCGeoPar, drawing the prototype pad plane";
+            fNColumns = 128;
+            fNRows = 44;
+            fPadSize = 2.0;
+        }
+    }
+    LOG(info) << "R3BGTPCEventDrawTask::Init: Pad plane of " << fNColumns << "x" << fNRows << " pads of "
+              << fPadSize << " mm";
+
     // Data
     fHitCA = (TClonesArray*)ioMan->GetObject("GTPCHitData");
     if (fHitCA)
@@ -242,7 +284,7 @@ void R3BGTPCEventDrawTask::DrawPadPlane()
         return;
     }
 
-    fMap->GeneratePadPlane();
+    fMap->GeneratePadPlane(fNColumns, fNRows, fPadSize);
     fPadPlane = fMap->GetPadPlane();
     fCvsPadPlane->cd();
     // fPadPlane -> Draw("COLZ L0"); //0  == bin lines adre not drawn
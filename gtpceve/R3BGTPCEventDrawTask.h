@@ -2,6 +2,7 @@
 #define R3BGTPCEVENTDRAWTASK_H
 
 class R3BGTPCEventManager;
+class R3BGTPCGeoPar;
 
 // GLAD-TPC classes
 #include "R3BGTPCHitData.h"
@@ -41,19 +42,32 @@ class R3BGTPCEventDrawTask : public FairTask
 
     ~R3BGTPCEventDrawTask();
 
+    void SetParContainers();
     InitStatus Init();
     void Exec(Option_t* option);
     void Reset();
 
+    // Pad plane drawn instead of the R3BGTPCPadGeometry of the GTPCGeoPar parameters
+    void SetPadPlane(Int_t nColumns, Int_t nRows, Double_t padSize)
+    {
+        fNColumns = nColumns;
+        fNRows = nRows;
+        fPadSize = padSize;
+    }
+
   private:
     R3BGTPCEventManager* fEventManager;
     R3BGTPCMap* fMap;
+    R3BGTPCGeoPar* fGTPCGeoPar;
 
     // Canvases and histograms
     TCanvas* fCvsPadPlane;
     TH2Poly* fPadPlane;
     TCanvas* fCvsPadWave;
     TH1I* fPadWave;
+    Int_t fNColumns;   // Pads along z
+    Int_t fNRows;      // Pads along x
+    Double_t fPadSize; // Pad pitch [mm]
 
     // Data containers
     TClonesArray* fHitCA;
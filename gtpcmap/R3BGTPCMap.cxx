@@ -1,11 +1,9 @@
 #include "R3BGTPCMap.h"
 
 R3BGTPCMap::R3BGTPCMap()
-    : fPadCoord(boost::extents[5632][4][2])
+    : fPadCoord(boost::extents[0][4][2])
 {
 
-    fPadCoord.resize(boost::extents[5632][4][2]);
-    std::fill(fPadCoord.data(), fPadCoord.data() + fPadCoord.num_elements(), 0);
     fPadPlane = new TH2Poly();
 
     std::cout << " GLADTPC Map initialized " << std::endl;
@@ -14,20 +12,24 @@ R3BGTPCMap::R3BGTPCMap()
 
 R3BGTPCMap::~R3BGTPCMap() {}
 
-void R3BGTPCMap::GeneratePadPlane()
+void R3BGTPCMap::GeneratePadPlane(Int_t nColumns, Int_t nRows, Double_t padSize)
 {
 
-    Float_t pad_size = 2.0;      // mm
+    Float_t pad_size = padSize;  // mm
     Float_t pad_spacing = 0.001; // mm
 
     Float_t ZOffset = 0.0; // 272.7;
     Float_t XOffset = 0.0; // 5.8;
 
+    Int_t nPads = nColumns * nRows;
+    fPadCoord.resize(boost::extents[nPads][4][2]);
+    std::fill(fPadCoord.data(), fPadCoord.data() + fPadCoord.num_elements(), 0);
+
     Int_t padCnt = 0;
 
     // x - y (Z - X in GLAD convention)
-    for (auto icol = 0; icol < 128; ++icol)
-        for (auto irow = 0; irow < 44; ++irow)
+    for (auto icol = 0; icol < nColumns; ++icol)
+        for (auto irow = 0; irow < nRows; ++irow)
         {
             fPadCoord[padCnt][0][0] = pad_size * (Float_t)icol + ZOffset;
             fPadCoord[padCnt][0][1] = pad_size * (Float_t)irow + XOffset;
@@ -40,7 +42,7 @@ void R3BGTPCMap::GeneratePadPlane()
             ++padCnt;
         }
 
-    for (auto ipad = 0; ipad < 5632; ++ipad)
+    for (auto ipad = 0; ipad < nPads; ++ipad)
     {
         Double_t px[] = { fPadCoord[ipad][0][0],
                           fPadCoord[ipad][1][0],
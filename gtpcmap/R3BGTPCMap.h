@@ -29,7 +29,9 @@ class R3BGTPCMap : public TObject
     typedef boost::multi_array<double, 3> multiarray;
     typedef multiarray::index index;
 
-    void GeneratePadPlane();
+    /** Pad plane of nColumns (along z) x nRows (along x) pads of padSize [mm],
+     ** numbered as in R3BGTPCPadGeometry. The default is the prototype **/
+    void GeneratePadPlane(Int_t nColumns = 128, Int_t nRows = 44, Double_t padSize = 2.0);
     Int_t BinToPad(Int_t binval);
     std::vector<Float_t> CalcPadCenter(Int_t PadRef);
     TH2Poly* GetPadPlane();
@@ -43,6 +43,17 @@
 #include <TVector3.h>
 #include <TrackCand.h>
 
+#include <mutex>
+
+namespace
+{
+    // The GENFIT field and material effects are process-wide singletons: they
+    // are set up once and the fits of all the fitters of the process are
+    // serialized, so tasks of independent runs can live in the same process
+    std::once_flag gGenfitInit;
+    std::mutex gGenfitMutex;
+} // namespace
+
 R3BGTPCFitter::R3BGTPCFitter()
 {
     fTPCDetID = 0;
@@ -60,9 +71,13 @@ R3BGTPCFitter::R3BGTPCFitter()
     fMeasurementFactory = new genfit::MeasurementFactory<genfit::AbsMeasurement>();
     fMeasurementFactory->addProducer(fTPCDetID, fMeasurementProducer);
 
-    genfit::FieldManager::getInstance()->init(new genfit::ConstField(0.0, 20.0, 0.0)); // kGauss
-    genfit::MaterialEffects* materialEffects = genfit::MaterialEffects::getInstance();
-    materialEffects->init(new genfit::TGeoMaterialInterface());
+    std::call_once(gGenfitInit,
+                   []
+                   {
+                       genfit::FieldManager::getInstance()->init(new genfit::ConstField(0.0, 20.0, 0.0)); // kGauss
+                       genfit::MaterialEffects* materialEffects = genfit::MaterialEffects::getInstance();
+                       materialEffects->init(new genfit::TGeoMaterialInterface());
+                   });
 }
 
 R3BGTPCFitter::~R3BGTPCFitter()
@@ -84,6 +99,7 @@ void R3BGTPCFitter::Init()
 
 genfit::Track* R3BGTPCFitter::FitTrack(R3BGTPCTrackData* track)
 {
+    std::lock_guard<std::mutex> lock(gGenfitMutex);
     fHitClusterArray->Delete();
     genfit::TrackCand trackCand;
 
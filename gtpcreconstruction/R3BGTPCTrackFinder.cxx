@@ -32,7 +32,7 @@ constexpr auto cGREEN = "\033[1;32m";
 
 R3BGTPCTrackFinder::R3BGTPCTrackFinder() {}
 
-void R3BGTPCTrackFinder::eventToClusters(TClonesArray* hitCA, PointCloud& cloud)
+void R3BGTPCTrackFinder::eventToClusters(const TClonesArray* hitCA, PointCloud& cloud) const
 {
 
     Int_t nHits = hitCA->GetEntries();
@@ -60,7 +60,7 @@ void R3BGTPCTrackFinder::eventToClusters(TClonesArray* hitCA, PointCloud& cloud)
 std::unique_ptr<R3BGTPCTrackData> R3BGTPCTrackFinder::clustersToTrack(PointCloud& cloud,
                                                                       const std::vector<cluster_t>& clusters,
                                                                       TClonesArray* trackCA,
-                                                                      TClonesArray* hitCA)
+                                                                      const TClonesArray* hitCA) const
 {
 
     std::vector<R3BGTPCTrackData> tracks;
@@ -135,7 +135,7 @@ std::unique_ptr<R3BGTPCTrackData> R3BGTPCTrackFinder::clustersToTrack(PointCloud
     return NULL;
 }
 
-void R3BGTPCTrackFinder::Clusterize(R3BGTPCTrackData& track, Float_t distance, Float_t radius)
+void R3BGTPCTrackFinder::Clusterize(R3BGTPCTrackData& track, Float_t distance, Float_t radius) const
 {
 
     std::vector<R3BGTPCHitData> hitArray = track.GetHitArray();
@@ -33,12 +33,14 @@ class R3BGTPCTrackFinder
   public:
     R3BGTPCTrackFinder();
     virtual ~R3BGTPCTrackFinder() = default;
-    void Clusterize(R3BGTPCTrackData& track, Float_t distance, Float_t radius);
-    void eventToClusters(TClonesArray* hitCA, PointCloud& cloud);
+    // The finder keeps no state from one event to the next: its methods are
+    // const and can be called from several threads on their own arrays
+    void Clusterize(R3BGTPCTrackData& track, Float_t distance, Float_t radius) const;
+    void eventToClusters(const TClonesArray* hitCA, PointCloud& cloud) const;
     std::unique_ptr<R3BGTPCTrackData> clustersToTrack(PointCloud& cloud,
                                                       const std::vector<cluster_t>& clusters,
                                                       TClonesArray* trackCA,
-                                                      TClonesArray* hitCA);
+                                                      const TClonesArray* hitCA) const;
 
     void SetScluster(float s) { inputParams.s = s; }
     void SetKtriplet(size_t k) { inputParams.k = k; }
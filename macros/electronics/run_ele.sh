@@ -11,10 +11,12 @@ cmake ..
 make -j2
 echo -e "\n---------------------Running the macro in different cores!---------------------\n"
 core=7
+# seed of the noise and gain fluctuations, the same for every part (optional first argument)
+seed=${1:-20210209}
 
 for i in `seq 1 $core`;
 do
-./AGetElectronics $i $core &
+./AGetElectronics $i $core $seed &
 done
 wait
 echo -e "\n---------------------Merging the root output file!---------------------\n"